@@ -10,8 +10,148 @@
 #include <arpa/inet.h>
 #include <errno.h>
 #include <stdint.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
 #include <moonbit.h>
 
+// ========== 日志 ==========
+//
+// 日志先写入无锁 SPSC 环形缓冲区（生产者是 MoonBit 主线程），
+// 由后台写线程批量 write 到标准输出，请求处理线程不再调用 printf/fflush。
+//
+// 编译期级别：AUTUMN_LOG_LEVEL 以下的 AUTUMN_LOG_* 调用被预处理器消除，
+// 例如 -DAUTUMN_LOG_LEVEL=0 打开 DEBUG 日志（包括响应的十六进制转储）。
+
+#define AUTUMN_LOG_LEVEL_TRACE 0
+#define AUTUMN_LOG_LEVEL_DEBUG 1
+#define AUTUMN_LOG_LEVEL_INFO 2
+#define AUTUMN_LOG_LEVEL_WARN 3
+#define AUTUMN_LOG_LEVEL_ERROR 4
+
+#ifndef AUTUMN_LOG_LEVEL
+#define AUTUMN_LOG_LEVEL AUTUMN_LOG_LEVEL_INFO
+#endif
+
+static void autumn_log_printf(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+
+#define AUTUMN_LOG(level, ...) \
+    do { \
+        if ((level) >= AUTUMN_LOG_LEVEL) { \
+            autumn_log_printf(__VA_ARGS__); \
+        } \
+    } while (0)
+#define AUTUMN_LOG_DEBUG(...) AUTUMN_LOG(AUTUMN_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define AUTUMN_LOG_INFO(...) AUTUMN_LOG(AUTUMN_LOG_LEVEL_INFO, __VA_ARGS__)
+#define AUTUMN_LOG_WARN(...) AUTUMN_LOG(AUTUMN_LOG_LEVEL_WARN, __VA_ARGS__)
+#define AUTUMN_LOG_ERROR(...) AUTUMN_LOG(AUTUMN_LOG_LEVEL_ERROR, __VA_ARGS__)
+
+// 环形缓冲区大小（必须是 2 的幂）
+#define AUTUMN_LOG_RING_SIZE (1u << 20)
+#define AUTUMN_LOG_RING_MASK (AUTUMN_LOG_RING_SIZE - 1)
+
+static char log_ring[AUTUMN_LOG_RING_SIZE];
+static _Atomic size_t log_head = 0;  // 生产者写入位置（单调递增）
+static _Atomic size_t log_tail = 0;  // 消费者读取位置（单调递增）
+static _Atomic uint64_t log_dropped = 0;  // 缓冲区满时丢弃的字节数
+static _Atomic int log_stopping = 0;
+static pthread_t log_writer_thread;
+static pthread_once_t log_writer_once = PTHREAD_ONCE_INIT;
+static int log_writer_started = 0;
+
+// 将 [tail, head) 之间的数据写到标准输出，返回写出的字节数
+static size_t log_drain(void) {
+    size_t tail = atomic_load_explicit(&log_tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&log_head, memory_order_acquire);
+    size_t total = head - tail;
+    while (tail != head) {
+        size_t offset = tail & AUTUMN_LOG_RING_MASK;
+        size_t chunk = head - tail;
+        if (chunk > AUTUMN_LOG_RING_SIZE - offset) {
+            chunk = AUTUMN_LOG_RING_SIZE - offset;
+        }
+        ssize_t written = write(STDOUT_FILENO, log_ring + offset, chunk);
+        if (written <= 0) {
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            break;  // 标准输出不可写，放弃本批数据
+        }
+        tail += (size_t)written;
+    }
+    atomic_store_explicit(&log_tail, head, memory_order_release);
+    return total;
+}
+
+// 后台写线程：有数据时批量写出，空闲时休眠 1ms
+static void* log_writer_main(void* arg) {
+    (void)arg;
+    struct timespec idle = {0, 1000000};
+    while (!atomic_load_explicit(&log_stopping, memory_order_acquire)) {
+        if (log_drain() == 0) {
+            nanosleep(&idle, NULL);
+        }
+    }
+    return NULL;
+}
+
+// 进程退出时停止写线程并写出剩余日志
+static void log_writer_shutdown(void) {
+    if (log_writer_started) {
+        atomic_store_explicit(&log_stopping, 1, memory_order_release);
+        pthread_join(log_writer_thread, NULL);
+    }
+    log_drain();
+}
+
+static void log_writer_start(void) {
+    if (pthread_create(&log_writer_thread, NULL, log_writer_main, NULL) == 0) {
+        log_writer_started = 1;
+    }
+    atexit(log_writer_shutdown);
+}
+
+// 写入环形缓冲区（只能由单个生产者线程调用），空间不足时丢弃并计数
+static int log_push(const char* data, size_t len) {
+    pthread_once(&log_writer_once, log_writer_start);
+    if (!log_writer_started) {
+        // 写线程创建失败：直接同步写出
+        return write(STDOUT_FILENO, data, len) == (ssize_t)len;
+    }
+    size_t head = atomic_load_explicit(&log_head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&log_tail, memory_order_acquire);
+    if (len > AUTUMN_LOG_RING_SIZE - (head - tail)) {
+        atomic_fetch_add_explicit(&log_dropped, len, memory_order_relaxed);
+        return 0;
+    }
+    size_t offset = head & AUTUMN_LOG_RING_MASK;
+    size_t first = AUTUMN_LOG_RING_SIZE - offset;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(log_ring + offset, data, first);
+    memcpy(log_ring, data + first, len - first);
+    atomic_store_explicit(&log_head, head + len, memory_order_release);
+    return 1;
+}
+
+static void autumn_log_printf(const char* fmt, ...) {
+    char line[1024];
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    if (len < 0) {
+        return;
+    }
+    if ((size_t)len >= sizeof(line)) {
+        len = sizeof(line) - 1;
+        line[len - 1] = '\n';  // 截断时保留换行
+    }
+    log_push(line, (size_t)len);
+}
+
 // 静态缓冲区用于 UTF-16 到 UTF-8 转换
 static char utf8_buffer[8192];  // 8KB 缓冲区
 
@@ -54,8 +194,7 @@ int autumn_create_server_socket(int port) {
         return -1;
     }
 
-    printf("[C] Server socket created successfully on port %d\n", port);
-    fflush(stdout);
+    AUTUMN_LOG_INFO("[C] Server socket created successfully on port %d\n", port);
     return server_fd;
 }
 
@@ -65,8 +204,7 @@ int autumn_accept_connection(int server_fd) {
     socklen_t addrlen = sizeof(address);
     int new_socket = accept(server_fd, (struct sockaddr *)&address, &addrlen);
     if (new_socket >= 0) {
-        printf("[C] Accepted connection from client (fd=%d)\n", new_socket);
-        fflush(stdout);
+        AUTUMN_LOG_DEBUG("[C] Accepted connection from client (fd=%d)\n", new_socket);
     } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
         // 忽略非阻塞 socket 的错误，其他错误记录
         perror("accept failed");
@@ -88,12 +226,10 @@ int autumn_read_request(int client_fd) {
     if (bytes_read > 0) {
         request_buffer[bytes_read] = '\0';
         request_buffer_len = bytes_read;
-        printf("[C] Read %d bytes from client\n", bytes_read);
-        printf("[C] First 100 chars: %.100s\n", request_buffer);
-        fflush(stdout);
+        AUTUMN_LOG_DEBUG("[C] Read %d bytes from client\n", bytes_read);
+        AUTUMN_LOG_DEBUG("[C] First 100 chars: %.100s\n", request_buffer);
     } else if (bytes_read == 0) {
-        printf("[C] Client closed connection\n");
-        fflush(stdout);
+        AUTUMN_LOG_DEBUG("[C] Client closed connection\n");
         request_buffer[0] = '\0';
         request_buffer_len = 0;
     } else {
@@ -177,7 +313,7 @@ static int moonbit_string_to_bytes(moonbit_string_t str, int str_len, char* buff
 // 在 native 后端，MoonBit 字符串可能是 UTF-16 编码的
 int autumn_send_response(int client_fd, moonbit_string_t response, int response_len) {
     if (response == NULL) {
-        printf("[C] Error: response is NULL\n");
+        AUTUMN_LOG_ERROR("[C] Error: response is NULL\n");
         return -1;
     }
     
@@ -185,46 +321,48 @@ int autumn_send_response(int client_fd, moonbit_string_t response, int response_
     int utf8_len = moonbit_string_to_bytes(response, response_len, utf8_buffer, sizeof(utf8_buffer));
     
     if (utf8_len <= 0) {
-        printf("[C] Error: Failed to convert MoonBit string to UTF-8\n");
+        AUTUMN_LOG_ERROR("[C] Error: Failed to convert MoonBit string to UTF-8\n");
         return -1;
     }
     
-    // 调试：打印响应内容
-    printf("[C] Sending response (MoonBit length=%d, UTF-8 bytes=%d):\n", response_len, utf8_len);
-    printf("[C] First 100 bytes (hex): ");
-    int print_len = (utf8_len > 100) ? 100 : utf8_len;
-    for (int i = 0; i < print_len; i++) {
-        printf("%02x ", (unsigned char)utf8_buffer[i]);
-        if ((i + 1) % 16 == 0) printf("\n[C]                      ");
-    }
-    printf("\n[C] First 100 bytes (ASCII, escaped): ");
-    for (int i = 0; i < print_len; i++) {
-        unsigned char c = (unsigned char)utf8_buffer[i];
-        if (c >= 32 && c < 127 && c != '\r' && c != '\n') {
-            printf("%c", c);
-        } else if (c == '\r') {
-            printf("\\r");
-        } else if (c == '\n') {
-            printf("\\n");
-        } else {
-            printf("\\x%02x", c);
+#if AUTUMN_LOG_LEVEL <= AUTUMN_LOG_LEVEL_DEBUG
+    // 调试：打印响应内容（十六进制 + 转义），只在 DEBUG 构建中编译
+    {
+        char dump[1024];
+        int pos = 0;
+        int print_len = (utf8_len > 100) ? 100 : utf8_len;
+        pos += snprintf(dump + pos, sizeof(dump) - pos,
+                        "[C] Sending response (MoonBit length=%d, UTF-8 bytes=%d):\n[C] First 100 bytes (hex): ",
+                        response_len, utf8_len);
+        for (int i = 0; i < print_len && pos < (int)sizeof(dump) - 8; i++) {
+            pos += snprintf(dump + pos, sizeof(dump) - pos, "%02x ", (unsigned char)utf8_buffer[i]);
+        }
+        pos += snprintf(dump + pos, sizeof(dump) - pos, "\n[C] First 100 bytes (ASCII, escaped): ");
+        for (int i = 0; i < print_len && pos < (int)sizeof(dump) - 8; i++) {
+            unsigned char c = (unsigned char)utf8_buffer[i];
+            if (c >= 32 && c < 127) {
+                dump[pos++] = (char)c;
+            } else if (c == '\r') {
+                pos += snprintf(dump + pos, sizeof(dump) - pos, "\\r");
+            } else if (c == '\n') {
+                pos += snprintf(dump + pos, sizeof(dump) - pos, "\\n");
+            } else {
+                pos += snprintf(dump + pos, sizeof(dump) - pos, "\\x%02x", c);
+            }
         }
+        dump[pos] = '\0';
+        AUTUMN_LOG_DEBUG("%s\n", dump);
     }
-    printf("\n[C] First 100 bytes (raw): ");
-    fwrite(utf8_buffer, 1, print_len, stdout);
-    printf("\n");
-    fflush(stdout);
-    
+#endif
+
     // 发送响应
     ssize_t bytes_sent = send(client_fd, utf8_buffer, utf8_len, 0);
     if (bytes_sent > 0) {
-        printf("[C] Sent %zd bytes to client (expected %d)\n", bytes_sent, utf8_len);
-        fflush(stdout);
+        AUTUMN_LOG_DEBUG("[C] Sent %zd bytes to client (expected %d)\n", bytes_sent, utf8_len);
     } else if (bytes_sent < 0) {
         perror("send failed");
     } else {
-        printf("[C] Warning: send returned 0 bytes\n");
-        fflush(stdout);
+        AUTUMN_LOG_WARN("[C] Warning: send returned 0 bytes\n");
     }
     return (int)bytes_sent;
 }
@@ -239,3 +377,59 @@ void autumn_close_server(int server_fd) {
     close(server_fd);
 }
 
+// 单调时钟（纳秒），用于请求指标计时
+int64_t autumn_monotonic_nanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + (int64_t)ts.tv_nsec;
+}
+
+// 将 MoonBit 日志文本（UTF-16）编码为 UTF-8 并写入日志环形缓冲区
+// 返回值：1 表示写入成功，0 表示缓冲区已满被丢弃
+int autumn_log_write(moonbit_string_t text, int text_len) {
+    if (text == NULL || text_len <= 0) {
+        return 1;
+    }
+    char stack_buffer[4096];
+    size_t capacity = (size_t)text_len * 3;
+    char* buffer = capacity <= sizeof(stack_buffer) ? stack_buffer : (char*)malloc(capacity);
+    if (buffer == NULL) {
+        return 0;
+    }
+    const uint16_t* units = (const uint16_t*)text;
+    size_t pos = 0;
+    for (int i = 0; i < text_len; i++) {
+        uint32_t cp = units[i];
+        if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < text_len
+            && units[i + 1] >= 0xDC00 && units[i + 1] <= 0xDFFF) {
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (units[i + 1] - 0xDC00);
+            i++;
+        }
+        if (cp < 0x80) {
+            buffer[pos++] = (char)cp;
+        } else if (cp < 0x800) {
+            buffer[pos++] = (char)(0xC0 | (cp >> 6));
+            buffer[pos++] = (char)(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            buffer[pos++] = (char)(0xE0 | (cp >> 12));
+            buffer[pos++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+            buffer[pos++] = (char)(0x80 | (cp & 0x3F));
+        } else {
+            // 代理对：2 个 UTF-16 单元编码为 4 字节，不超过 2 * 3 的预留空间
+            buffer[pos++] = (char)(0xF0 | (cp >> 18));
+            buffer[pos++] = (char)(0x80 | ((cp >> 12) & 0x3F));
+            buffer[pos++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+            buffer[pos++] = (char)(0x80 | (cp & 0x3F));
+        }
+    }
+    int ok = log_push(buffer, pos);
+    if (buffer != stack_buffer) {
+        free(buffer);
+    }
+    return ok;
+}
+
+// 获取因日志缓冲区已满而丢弃的字节数
+int64_t autumn_log_dropped_bytes(void) {
+    return (int64_t)atomic_load_explicit(&log_dropped, memory_order_relaxed);
+}
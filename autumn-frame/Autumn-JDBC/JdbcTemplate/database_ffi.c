@@ -157,6 +157,24 @@ const char* autumn_sqlite3_errmsg(int32_t handle) {
   return sqlite3_errmsg(sqlite_connections[handle]);
 }
 
+// 获取错误码（主错误码）
+int32_t autumn_sqlite3_errcode(int32_t handle) {
+  if (handle < 0 || handle >= MAX_CONNECTIONS || sqlite_connections[handle] == NULL) {
+    return -1;
+  }
+  
+  return sqlite3_extended_errcode(sqlite_connections[handle]) & 0xff;
+}
+
+// 获取连接打开以来累计修改的行数（两次调用之差是其间语句修改的行数）
+int32_t autumn_sqlite3_total_changes(int32_t handle) {
+  if (handle < 0 || handle >= MAX_CONNECTIONS || sqlite_connections[handle] == NULL) {
+    return -1;
+  }
+  
+  return sqlite3_total_changes(sqlite_connections[handle]);
+}
+
 #endif  // ENABLE_SQLITE
 
 // ========== MySQL 实现 ==========
@@ -267,6 +285,28 @@ const char* autumn_mysql_errmsg(int32_t handle) {
   return mysql_error(mysql_connections[handle]);
 }
 
+// 获取错误码（mysql_errno，0 表示没有错误）
+int32_t autumn_mysql_errno(int32_t handle) {
+  if (handle < 0 || handle >= MAX_CONNECTIONS || mysql_connections[handle] == NULL) {
+    return -1;
+  }
+  
+  return (int32_t)mysql_errno(mysql_connections[handle]);
+}
+
+// 获取最后一条语句影响的行数（行数未知时返回 -1）
+int32_t autumn_mysql_affected_rows(int32_t handle) {
+  if (handle < 0 || handle >= MAX_CONNECTIONS || mysql_connections[handle] == NULL) {
+    return -1;
+  }
+  
+  my_ulonglong affected = mysql_affected_rows(mysql_connections[handle]);
+  if (affected == (my_ulonglong)-1) {
+    return -1;
+  }
+  return affected > INT32_MAX ? INT32_MAX : (int32_t)affected;
+}
+
 #endif  // ENABLE_MYSQL
 
 // ========== PostgreSQL 实现 ==========
@@ -0,0 +1,254 @@
+// memdb_storage.c - MemoryDatabase 持久化与批量导入导出的文件 I/O
+//
+// 由 WriteAheadLog.mbt 和 BulkLoad.mbt 通过 FFI 调用，只做 MoonBit 标准库无法完成的系统调用：
+// - 追加写入与 fdatasync（日志组提交）
+// - mmap 读取整个文件（快照与日志恢复）
+// - 写临时文件 + fsync + rename 原子替换快照
+// - 截断日志（丢弃崩溃时写了一半的尾部）
+// - 创建 / 覆盖导出文件（分块写入）
+//
+// 本文件是 JdbcTemplate 包的 native-stub（见 moon.pkg.json），native 后端构建时随包编译链接。
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <moonbit.h>
+
+#define AUTUMN_MEMDB_PATH_MAX 4096
+
+// MoonBit String (UTF-16) 转换为 UTF-8 路径，处理代理对
+// 返回写入的字节数，缓冲区不足时返回 -1
+static int memdb_path_to_utf8(moonbit_string_t str, int str_len, char *buffer, int buffer_size) {
+    int out = 0;
+    for (int i = 0; i < str_len; i++) {
+        uint32_t code = str[i];
+        if (code >= 0xD800 && code <= 0xDBFF && i + 1 < str_len) {
+            uint32_t low = str[i + 1];
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                i++;
+            }
+        }
+        int need = code < 0x80 ? 1 : code < 0x800 ? 2 : code < 0x10000 ? 3 : 4;
+        if (out + need >= buffer_size) {
+            return -1;
+        }
+        if (need == 1) {
+            buffer[out++] = (char)code;
+        } else if (need == 2) {
+            buffer[out++] = (char)(0xC0 | (code >> 6));
+            buffer[out++] = (char)(0x80 | (code & 0x3F));
+        } else if (need == 3) {
+            buffer[out++] = (char)(0xE0 | (code >> 12));
+            buffer[out++] = (char)(0x80 | ((code >> 6) & 0x3F));
+            buffer[out++] = (char)(0x80 | (code & 0x3F));
+        } else {
+            buffer[out++] = (char)(0xF0 | (code >> 18));
+            buffer[out++] = (char)(0x80 | ((code >> 12) & 0x3F));
+            buffer[out++] = (char)(0x80 | ((code >> 6) & 0x3F));
+            buffer[out++] = (char)(0x80 | (code & 0x3F));
+        }
+    }
+    buffer[out] = '\0';
+    return out;
+}
+
+// 写满 len 字节（处理 EINTR 和部分写入）
+static int memdb_write_all(int fd, const uint8_t *data, size_t len) {
+    size_t written = 0;
+    while (written < len) {
+        ssize_t n = write(fd, data + written, len - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        written += (size_t)n;
+    }
+    return 0;
+}
+
+// fsync 文件所在目录，使 rename 和新建文件持久化
+static void memdb_sync_parent(const char *path) {
+    char dir[AUTUMN_MEMDB_PATH_MAX];
+    strncpy(dir, path, sizeof(dir) - 1);
+    dir[sizeof(dir) - 1] = '\0';
+    char *slash = strrchr(dir, '/');
+    if (slash == NULL) {
+        strcpy(dir, ".");
+    } else if (slash == dir) {
+        dir[1] = '\0';
+    } else {
+        *slash = '\0';
+    }
+    int fd = open(dir, O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+// 创建目录（已存在时视为成功）
+int autumn_memdb_ensure_dir(moonbit_string_t path, int path_len) {
+    char buffer[AUTUMN_MEMDB_PATH_MAX];
+    if (memdb_path_to_utf8(path, path_len, buffer, sizeof(buffer)) < 0) {
+        return -1;
+    }
+    if (mkdir(buffer, 0755) == 0 || errno == EEXIST) {
+        return 0;
+    }
+    return -1;
+}
+
+// 以追加方式打开（必要时创建）日志文件，返回文件描述符，失败返回 -1
+int autumn_memdb_open_append(moonbit_string_t path, int path_len) {
+    char buffer[AUTUMN_MEMDB_PATH_MAX];
+    if (memdb_path_to_utf8(path, path_len, buffer, sizeof(buffer)) < 0) {
+        return -1;
+    }
+    int fd = open(buffer, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd >= 0) {
+        memdb_sync_parent(buffer);
+    }
+    return fd;
+}
+
+// 以覆盖方式打开（必要时创建）文件，返回文件描述符，失败返回 -1
+int autumn_memdb_open_write(moonbit_string_t path, int path_len) {
+    char buffer[AUTUMN_MEMDB_PATH_MAX];
+    if (memdb_path_to_utf8(path, path_len, buffer, sizeof(buffer)) < 0) {
+        return -1;
+    }
+    return open(buffer, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+}
+
+// 追加写入 data 的前 len 字节，成功返回 0
+int autumn_memdb_write(int fd, moonbit_bytes_t data, int len) {
+    if (fd < 0 || len < 0 || len > (int)Moonbit_array_length(data)) {
+        return -1;
+    }
+    return memdb_write_all(fd, data, (size_t)len);
+}
+
+// 将已写入的数据落盘，成功返回 0
+int autumn_memdb_sync(int fd) {
+#if defined(__linux__)
+    return fdatasync(fd);
+#else
+    return fsync(fd);
+#endif
+}
+
+// 关闭文件描述符
+int autumn_memdb_close(int fd) {
+    return close(fd);
+}
+
+// 将文件截断为 size 字节并落盘，成功返回 0
+int autumn_memdb_truncate(moonbit_string_t path, int path_len, int size) {
+    char buffer[AUTUMN_MEMDB_PATH_MAX];
+    if (memdb_path_to_utf8(path, path_len, buffer, sizeof(buffer)) < 0) {
+        return -1;
+    }
+    int fd = open(buffer, O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    int result = ftruncate(fd, (off_t)size);
+    if (result == 0) {
+        result = fsync(fd);
+    }
+    close(fd);
+    return result;
+}
+
+// 读取整个文件：mmap 后一次复制到 MoonBit Bytes
+// status[0] 返回读取结果：0 读取成功（文件可能为空），1 文件不存在，-1 文件存在但无法读取
+// 后两种情况返回长度为 0 的 Bytes
+moonbit_bytes_t autumn_memdb_read_file(moonbit_string_t path, int path_len, int32_t *status) {
+    char buffer[AUTUMN_MEMDB_PATH_MAX];
+    status[0] = -1;
+    if (memdb_path_to_utf8(path, path_len, buffer, sizeof(buffer)) < 0) {
+        return moonbit_make_bytes(0, 0);
+    }
+    int fd = open(buffer, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            status[0] = 1;
+        }
+        return moonbit_make_bytes(0, 0);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size > INT32_MAX) {
+        close(fd);
+        return moonbit_make_bytes(0, 0);
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        status[0] = 0;
+        return moonbit_make_bytes(0, 0);
+    }
+    size_t size = (size_t)st.st_size;
+    void *mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return moonbit_make_bytes(0, 0);
+    }
+    madvise(mapped, size, MADV_SEQUENTIAL);
+    moonbit_bytes_t result = moonbit_make_bytes((int32_t)size, 0);
+    memcpy(result, mapped, size);
+    munmap(mapped, size);
+    status[0] = 0;
+    return result;
+}
+
+// 原子替换文件：写入 path.tmp，fsync，rename 覆盖 path，再 fsync 目录
+int autumn_memdb_replace_file(moonbit_string_t path, int path_len, moonbit_bytes_t data, int len) {
+    char target[AUTUMN_MEMDB_PATH_MAX];
+    char temp[AUTUMN_MEMDB_PATH_MAX + 8];
+    if (len < 0 || len > (int)Moonbit_array_length(data)) {
+        return -1;
+    }
+    if (memdb_path_to_utf8(path, path_len, target, sizeof(target)) < 0) {
+        return -1;
+    }
+    snprintf(temp, sizeof(temp), "%s.tmp", target);
+    int fd = open(temp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+    if (memdb_write_all(fd, data, (size_t)len) != 0 || fsync(fd) != 0) {
+        close(fd);
+        unlink(temp);
+        return -1;
+    }
+    close(fd);
+    if (rename(temp, target) != 0) {
+        unlink(temp);
+        return -1;
+    }
+    memdb_sync_parent(target);
+    return 0;
+}
+
+// 单调时钟（毫秒），用于按时间间隔组提交
+int64_t autumn_memdb_monotonic_millis(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// 单调时钟（微秒），用于语句耗时统计
+int64_t autumn_memdb_monotonic_micros(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""对比 moon bench 输出与基线，报告性能回归。
+
+moon bench 对每个基准测试输出一个标题行和一个统计行：
+
+    [...] bench .../DispatcherServlet_bench_wbtest.mbt:38 ("bench find_handler ...") ok
+    time (mean ± σ)         range (min … max)
+      1.23 µs ±   0.02 µs     1.20 µs …   1.27 µs  in 10 ×  81234 runs
+
+脚本提取每个基准测试的平均耗时（统一换算为纳秒），与基线对比，
+超过阈值（默认 10%）的视为回归，以非零状态码退出。
+基线为空或不存在时同样以非零状态码退出，避免把“没有对比”当作“没有回归”。
+"""
+
+import argparse
+import json
+import re
+import sys
+
+UNITS = {"ns": 1.0, "µs": 1e3, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+TITLE_LINE = re.compile(r'\("(?P<name>.+)"\)')
+
+MEAN_LINE = re.compile(r"^(?P<value>\d+(?:\.\d+)?)\s*(?P<unit>ns|µs|us|ms|s)\s+±")
+
+
+def parse_results(text):
+    results = {}
+    name = None
+    for line in text.splitlines():
+        title = TITLE_LINE.search(line)
+        if title is not None:
+            name = title.group("name")
+            continue
+        match = MEAN_LINE.match(line.strip())
+        if match is None or name is None:
+            continue
+        results[name] = float(match.group("value")) * UNITS[match.group("unit")]
+        name = None
+    return results
+
+
+def format_nanos(nanos):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("µs", 1e3)):
+        if nanos >= scale:
+            return f"{nanos / scale:.2f} {unit}"
+    return f"{nanos:.1f} ns"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("latest", help="moon bench 输出文件")
+    parser.add_argument("baseline", help="基线 JSON 文件")
+    parser.add_argument(
+        "--threshold",
+        type=float,
+        default=0.10,
+        help="回归阈值（相对基线的增幅，默认 0.10）",
+    )
+    parser.add_argument("--update", action="store_true", help="将本次结果写入基线")
+    args = parser.parse_args()
+
+    with open(args.latest, encoding="utf-8") as f:
+        latest = parse_results(f.read())
+    if not latest:
+        print("未在输出中找到基准测试结果", file=sys.stderr)
+        return 2
+
+    if args.update:
+        with open(args.baseline, "w", encoding="utf-8") as f:
+            json.dump(latest, f, ensure_ascii=False, indent=2, sort_keys=True)
+            f.write("\n")
+        print(f"已更新基线：{len(latest)} 项")
+        return 0
+
+    try:
+        with open(args.baseline, encoding="utf-8") as f:
+            baseline = json.load(f)
+    except FileNotFoundError:
+        baseline = {}
+
+    if not baseline:
+        # 没有基线时无法判断回归，不能当作通过
+        for name in sorted(latest):
+            print(f"  NEW   {name}: {format_nanos(latest[name])}")
+        print(
+            f"错误：基线 {args.baseline} 为空，未做任何回归检查；"
+            "请在用于性能对比的机器上执行 bench/run.sh --update 生成基线",
+            file=sys.stderr,
+        )
+        return 3
+
+    regressions = 0
+    for name in sorted(latest):
+        current = latest[name]
+        previous = baseline.get(name)
+        if previous is None:
+            print(f"  NEW   {name}: {format_nanos(current)}")
+            continue
+        change = (current - previous) / previous if previous > 0 else 0.0
+        status = "OK"
+        if change > args.threshold:
+            status = "SLOW"
+            regressions += 1
+        elif change < -args.threshold:
+            status = "FAST"
+        print(
+            f"  {status:<5} {name}: {format_nanos(previous)} -> "
+            f"{format_nanos(current)} ({change:+.1%})"
+        )
+
+    if regressions > 0:
+        print(f"{regressions} 项基准测试超过 {args.threshold:.0%} 阈值", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
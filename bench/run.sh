@@ -0,0 +1,20 @@
+#!/usr/bin/env bash
+# 运行全部基准测试，并与 bench/baseline.json 对比
+#
+# 用法：
+#   bench/run.sh            运行基准测试并检查回归（没有基线时用本次结果生成基线）
+#   bench/run.sh --update   运行基准测试并将结果写入基线
+set -euo pipefail
+
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+cd "$ROOT"
+
+BASELINE=bench/baseline.json
+EXTRA_ARGS=()
+if ! python3 -c 'import json, sys; sys.exit(0 if json.load(open(sys.argv[1])) else 1)' "$BASELINE" 2>/dev/null; then
+  echo "警告：$BASELINE 不存在或为空，本次结果将作为基线写入，不做回归检查" >&2
+  EXTRA_ARGS+=(--update)
+fi
+
+moon bench --target native 2>&1 | tee bench/latest.txt
+python3 bench/compare.py bench/latest.txt "$BASELINE" "$@" ${EXTRA_ARGS[@]+"${EXTRA_ARGS[@]}"}
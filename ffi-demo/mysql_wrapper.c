@@ -6,6 +6,7 @@
 // 使用：在 moon.pkg.json 的 "native-stub" 中配置
 
 #include <mysql/mysql.h>
+#include <limits.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -291,6 +292,40 @@ moonbit_string_t autumn_mysql_errmsg(int handle) {
     return result;
 }
 
+/// MySQL 获取最后的错误码（适配 MoonBit FFI）
+/// 
+/// 参数：
+/// - handle: 数据库连接句柄 ID
+/// 
+/// 返回：
+/// - mysql_errno 的错误码（0 表示没有错误），句柄无效时返回 -1
+int autumn_mysql_errno(int handle) {
+    MYSQL* mysql = get_mysql(handle);
+    if (mysql == NULL) {
+        return -1;
+    }
+    return (int)mysql_errno(mysql);
+}
+
+/// MySQL 获取最后一条语句影响的行数（适配 MoonBit FFI）
+/// 
+/// 参数：
+/// - handle: 数据库连接句柄 ID
+/// 
+/// 返回：
+/// - mysql_affected_rows 的结果，句柄无效或行数未知（例如语句失败）时返回 -1
+int autumn_mysql_affected_rows(int handle) {
+    MYSQL* mysql = get_mysql(handle);
+    if (mysql == NULL) {
+        return -1;
+    }
+    my_ulonglong affected = mysql_affected_rows(mysql);
+    if (affected == (my_ulonglong)-1) {
+        return -1;
+    }
+    return affected > INT_MAX ? INT_MAX : (int)affected;
+}
+
 
 
 
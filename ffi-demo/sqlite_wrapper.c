@@ -8,6 +8,11 @@
 #include <sqlite3.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdio.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 // MoonBit 运行时头文件
 #include <moonbit.h>
@@ -45,6 +50,634 @@ static void remove_db(int handle) {
     }
 }
 
+// ========== 预编译语句缓存 ==========
+//
+// 每个连接一个按 SQL 文本索引的 LRU 缓存：命中时 reset + 清除绑定后直接复用，
+// 省去 sqlite3_prepare 的解析和查询规划。语句使用 SQLITE_PREPARE_PERSISTENT 预编译，
+// 表结构变化时 SQLite 会自动重新编译，缓存不需要失效。
+// 只缓存单条语句（多条语句的 SQL 仍逐次 prepare / finalize）。
+
+#define STMT_CACHE_CAPACITY 32
+
+typedef struct {
+    char* sql;            // SQL 文本（malloc 分配，NULL 表示空槽位）
+    uint32_t hash;        // SQL 文本的哈希值
+    sqlite3_stmt* stmt;   // 预编译语句
+    uint64_t last_used;   // 最后使用时间（LRU 时钟）
+} stmt_cache_entry;
+
+typedef struct {
+    stmt_cache_entry entries[STMT_CACHE_CAPACITY];
+    int size;             // 已使用的槽位数
+    uint64_t clock;       // LRU 时钟
+    int hits;             // 命中次数
+    int misses;           // 未命中次数
+    int evictions;        // 淘汰次数
+} stmt_cache;
+
+static stmt_cache stmt_caches[MAX_HANDLES];
+
+// FNV-1a 哈希
+static uint32_t sql_hash(const char* sql) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)sql; *p; p++) {
+        hash = (hash ^ *p) * 16777619u;
+    }
+    return hash;
+}
+
+// 剩余文本是否只有空白和分号（即 SQL 只包含一条语句）
+static int sql_tail_empty(const char* tail) {
+    if (tail == NULL) {
+        return 1;
+    }
+    for (; *tail; tail++) {
+        if (*tail != ' ' && *tail != '\t' && *tail != '\n' && *tail != '\r' && *tail != ';') {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// 获取预编译语句：命中缓存时复用，否则 prepare 并放入缓存（淘汰最久未使用的语句）
+//
+// *cached 为 0 时语句不在缓存中，调用方使用后需要 finalize
+static sqlite3_stmt* stmt_cache_acquire(int handle, sqlite3* db, const char* sql, int* cached) {
+    stmt_cache* cache = &stmt_caches[handle];
+    uint32_t hash = sql_hash(sql);
+    *cached = 0;
+
+    for (int i = 0; i < STMT_CACHE_CAPACITY; i++) {
+        stmt_cache_entry* entry = &cache->entries[i];
+        if (entry->sql != NULL && entry->hash == hash && strcmp(entry->sql, sql) == 0) {
+            cache->hits++;
+            entry->last_used = ++cache->clock;
+            sqlite3_reset(entry->stmt);
+            sqlite3_clear_bindings(entry->stmt);
+            *cached = 1;
+            return entry->stmt;
+        }
+    }
+
+    cache->misses++;
+    sqlite3_stmt* stmt = NULL;
+    const char* tail = NULL;
+    if (sqlite3_prepare_v3(db, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, &tail) != SQLITE_OK) {
+        if (stmt != NULL) {
+            sqlite3_finalize(stmt);
+        }
+        return NULL;
+    }
+    if (stmt == NULL || !sql_tail_empty(tail)) {
+        return stmt;
+    }
+
+    // 选择空槽位，缓存已满时淘汰最久未使用的语句
+    stmt_cache_entry* slot = NULL;
+    for (int i = 0; i < STMT_CACHE_CAPACITY; i++) {
+        stmt_cache_entry* entry = &cache->entries[i];
+        if (entry->sql == NULL) {
+            slot = entry;
+            break;
+        }
+        if (slot == NULL || entry->last_used < slot->last_used) {
+            slot = entry;
+        }
+    }
+    if (slot->sql != NULL) {
+        sqlite3_finalize(slot->stmt);
+        free(slot->sql);
+        slot->sql = NULL;
+        cache->size--;
+        cache->evictions++;
+    }
+    char* key = strdup(sql);
+    if (key == NULL) {
+        return stmt;
+    }
+    slot->sql = key;
+    slot->hash = hash;
+    slot->stmt = stmt;
+    slot->last_used = ++cache->clock;
+    cache->size++;
+    *cached = 1;
+    return stmt;
+}
+
+// 使用完语句：缓存中的语句 reset（释放读锁，保留编译结果），其余 finalize
+static void stmt_cache_release(sqlite3_stmt* stmt, int cached) {
+    if (cached) {
+        sqlite3_reset(stmt);
+    } else {
+        sqlite3_finalize(stmt);
+    }
+}
+
+// 清空连接的语句缓存（关闭连接前调用）
+static void stmt_cache_clear(int handle) {
+    stmt_cache* cache = &stmt_caches[handle];
+    for (int i = 0; i < STMT_CACHE_CAPACITY; i++) {
+        stmt_cache_entry* entry = &cache->entries[i];
+        if (entry->sql != NULL) {
+            sqlite3_finalize(entry->stmt);
+            free(entry->sql);
+        }
+    }
+    memset(cache, 0, sizeof(*cache));
+}
+
+// ========== 列式结果批次 ==========
+//
+// 游标每次取出一批行，以列式二进制格式返回给 MoonBit（ResultCursor.mbt 负责解码）：
+//
+//   byte     状态：0 可能还有后续批次，1 结果集已读完，2 出错
+//   u32      列数（小端）
+//   u32      行数（小端）
+//   每列：
+//     uvarint  列名字节数，随后是列名（UTF-8）
+//     byte     类型：0 全为 NULL，1 整数，2 浮点数，3 文本，4 二进制
+//     bytes    NULL 位图，(行数 + 7) / 8 字节，第 i 位为 1 表示第 i 行为 NULL
+//     每行一个值（NULL 行同样占位）：整数为 zigzag varint，浮点数为 8 字节小端，
+//     文本和二进制为 uvarint 字节数 + 字节
+//
+// 一批数据先按行暂存为单元格，批次结束后再确定每列的类型并转为列式，
+// 因此内存占用只与批次大小有关，与结果集的总行数无关。
+
+#define CELL_NULL 0
+#define CELL_INT 1
+#define CELL_REAL 2
+#define CELL_TEXT 3
+#define CELL_BLOB 4
+
+#define DEFAULT_BATCH_ROWS 256
+#define MAX_BATCH_ROWS 65536
+
+// 可增长的字节缓冲区
+typedef struct {
+    uint8_t* data;
+    size_t len;
+    size_t cap;
+    int failed;           // 分配失败后不再写入
+} byte_buf;
+
+static int buf_reserve(byte_buf* buf, size_t extra) {
+    if (buf->failed) {
+        return 0;
+    }
+    if (buf->len + extra <= buf->cap) {
+        return 1;
+    }
+    size_t cap = buf->cap == 0 ? 1024 : buf->cap;
+    while (cap < buf->len + extra) {
+        cap *= 2;
+    }
+    uint8_t* data = (uint8_t*)realloc(buf->data, cap);
+    if (data == NULL) {
+        buf->failed = 1;
+        return 0;
+    }
+    buf->data = data;
+    buf->cap = cap;
+    return 1;
+}
+
+static void buf_put(byte_buf* buf, const void* data, size_t len) {
+    if (len > 0 && buf_reserve(buf, len)) {
+        memcpy(buf->data + buf->len, data, len);
+        buf->len += len;
+    }
+}
+
+static void buf_byte(byte_buf* buf, uint8_t value) {
+    buf_put(buf, &value, 1);
+}
+
+static void buf_u32(byte_buf* buf, uint32_t value) {
+    uint8_t bytes[4] = {
+        (uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)
+    };
+    buf_put(buf, bytes, 4);
+}
+
+static void buf_uvarint(byte_buf* buf, uint64_t value) {
+    uint8_t bytes[10];
+    int n = 0;
+    while (value >= 0x80) {
+        bytes[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    bytes[n++] = (uint8_t)value;
+    buf_put(buf, bytes, n);
+}
+
+static void buf_free(byte_buf* buf) {
+    free(buf->data);
+    memset(buf, 0, sizeof(*buf));
+}
+
+// 一批结果的构建器
+typedef struct {
+    int columns;
+    int rows;
+    byte_buf cells;       // 按行暂存的单元格：1 字节类型 + 值（数值 8 字节，文本/二进制 u32 长度 + 字节）
+    size_t* offsets;      // 每个单元格在 cells 中的偏移，共 rows * columns 个
+    size_t offsets_cap;
+    int* type_masks;      // 每列出现过的非 NULL 单元格类型（1 << CELL_*）
+    int failed;
+} batch_builder;
+
+static int batch_init(batch_builder* batch, int columns) {
+    memset(batch, 0, sizeof(*batch));
+    batch->columns = columns;
+    batch->type_masks = (int*)calloc(columns > 0 ? columns : 1, sizeof(int));
+    return batch->type_masks != NULL;
+}
+
+static void batch_free(batch_builder* batch) {
+    buf_free(&batch->cells);
+    free(batch->offsets);
+    free(batch->type_masks);
+    memset(batch, 0, sizeof(*batch));
+}
+
+// 记录下一个单元格的起始位置
+static int batch_begin_cell(batch_builder* batch) {
+    size_t index = (size_t)batch->rows * batch->columns;
+    size_t needed = index + batch->columns;
+    if (needed > batch->offsets_cap) {
+        size_t cap = batch->offsets_cap == 0 ? 256 : batch->offsets_cap;
+        while (cap < needed) {
+            cap *= 2;
+        }
+        size_t* offsets = (size_t*)realloc(batch->offsets, cap * sizeof(size_t));
+        if (offsets == NULL) {
+            batch->failed = 1;
+            return 0;
+        }
+        batch->offsets = offsets;
+        batch->offsets_cap = cap;
+    }
+    return 1;
+}
+
+static void batch_cell(batch_builder* batch, int column, int type, const void* data, size_t len) {
+    if (batch->failed || !batch_begin_cell(batch)) {
+        return;
+    }
+    batch->offsets[(size_t)batch->rows * batch->columns + column] = batch->cells.len;
+    buf_byte(&batch->cells, (uint8_t)type);
+    if (type == CELL_TEXT || type == CELL_BLOB) {
+        uint32_t size = (uint32_t)len;
+        buf_put(&batch->cells, &size, sizeof(size));
+        buf_put(&batch->cells, data, len);
+    } else if (type != CELL_NULL) {
+        buf_put(&batch->cells, data, 8);
+    }
+    if (type != CELL_NULL) {
+        batch->type_masks[column] |= 1 << type;
+    }
+    if (batch->cells.failed) {
+        batch->failed = 1;
+    }
+}
+
+static void batch_null(batch_builder* batch, int column) {
+    batch_cell(batch, column, CELL_NULL, NULL, 0);
+}
+
+static void batch_int(batch_builder* batch, int column, int64_t value) {
+    batch_cell(batch, column, CELL_INT, &value, 8);
+}
+
+static void batch_real(batch_builder* batch, int column, double value) {
+    batch_cell(batch, column, CELL_REAL, &value, 8);
+}
+
+// 写入文本或二进制单元格
+static void batch_bytes(batch_builder* batch, int column, int type, const void* data, size_t len) {
+    batch_cell(batch, column, type, data, len);
+}
+
+// 一行的所有列写完后调用
+static void batch_end_row(batch_builder* batch) {
+    if (!batch->failed) {
+        batch->rows++;
+    }
+}
+
+// 一列的输出类型：只有整数时为整数，只有数值时为浮点数，只有二进制时为二进制，混合类型统一为文本
+static int batch_column_type(int mask) {
+    if (mask == 0) {
+        return CELL_NULL;
+    }
+    if (mask == (1 << CELL_INT)) {
+        return CELL_INT;
+    }
+    if ((mask & ~((1 << CELL_INT) | (1 << CELL_REAL))) == 0) {
+        return CELL_REAL;
+    }
+    if (mask == (1 << CELL_BLOB)) {
+        return CELL_BLOB;
+    }
+    return CELL_TEXT;
+}
+
+// 写入一个单元格的值（按列的输出类型转换）
+static void batch_encode_value(byte_buf* out, const uint8_t* cell, int column_type) {
+    int type = cell[0];
+    int64_t int_value = 0;
+    double real_value = 0.0;
+    if (type == CELL_INT) {
+        memcpy(&int_value, cell + 1, 8);
+        real_value = (double)int_value;
+    } else if (type == CELL_REAL) {
+        memcpy(&real_value, cell + 1, 8);
+    }
+
+    switch (column_type) {
+        case CELL_INT:
+            buf_uvarint(out, ((uint64_t)int_value << 1) ^ (uint64_t)(int_value >> 63));
+            break;
+        case CELL_REAL: {
+            uint64_t bits;
+            memcpy(&bits, &real_value, 8);
+            for (int shift = 0; shift < 64; shift += 8) {
+                buf_byte(out, (uint8_t)(bits >> shift));
+            }
+            break;
+        }
+        default: {
+            char number[32];
+            const uint8_t* data = NULL;
+            uint32_t len = 0;
+            if (type == CELL_INT) {
+                len = (uint32_t)snprintf(number, sizeof(number), "%lld", (long long)int_value);
+                data = (const uint8_t*)number;
+            } else if (type == CELL_REAL) {
+                len = (uint32_t)snprintf(number, sizeof(number), "%.17g", real_value);
+                data = (const uint8_t*)number;
+            } else if (type == CELL_TEXT || type == CELL_BLOB) {
+                memcpy(&len, cell + 1, sizeof(len));
+                data = cell + 1 + sizeof(len);
+            }
+            buf_uvarint(out, len);
+            buf_put(out, data, len);
+            break;
+        }
+    }
+}
+
+// 构造只有状态、没有列和行的批次（出错或游标无效时使用）
+static moonbit_bytes_t batch_empty(int status) {
+    moonbit_bytes_t result = moonbit_make_bytes(9, 0);
+    result[0] = (uint8_t)status;
+    return result;
+}
+
+// 把暂存的单元格编码为列式批次，写入 out（C 堆内存，可以在工作线程中调用），失败时返回 0
+static int batch_encode(batch_builder* batch, int status, const char** names, byte_buf* out) {
+    if (batch->failed) {
+        return 0;
+    }
+    buf_byte(out, (uint8_t)status);
+    buf_u32(out, (uint32_t)batch->columns);
+    buf_u32(out, (uint32_t)batch->rows);
+    int bitmap_len = (batch->rows + 7) / 8;
+    for (int c = 0; c < batch->columns; c++) {
+        const char* name = names[c] != NULL ? names[c] : "";
+        size_t name_len = strlen(name);
+        buf_uvarint(out, name_len);
+        buf_put(out, name, name_len);
+
+        int column_type = batch_column_type(batch->type_masks[c]);
+        buf_byte(out, (uint8_t)column_type);
+        if (!buf_reserve(out, bitmap_len)) {
+            break;
+        }
+        uint8_t* bitmap = out->data + out->len;
+        memset(bitmap, 0, bitmap_len);
+        out->len += bitmap_len;
+        for (int r = 0; r < batch->rows; r++) {
+            const uint8_t* cell = batch->cells.data + batch->offsets[(size_t)r * batch->columns + c];
+            if (cell[0] == CELL_NULL) {
+                bitmap[r / 8] |= (uint8_t)(1 << (r % 8));
+            }
+        }
+        if (column_type == CELL_NULL) {
+            continue;
+        }
+        for (int r = 0; r < batch->rows; r++) {
+            const uint8_t* cell = batch->cells.data + batch->offsets[(size_t)r * batch->columns + c];
+            batch_encode_value(out, cell, column_type);
+        }
+    }
+    return !out->failed;
+}
+
+// 把编码好的批次复制为 MoonBit Bytes 并释放缓冲区（只能在调用线程中使用）
+static moonbit_bytes_t buf_take_bytes(byte_buf* buf) {
+    moonbit_bytes_t result = moonbit_make_bytes((int32_t)buf->len, 0);
+    if (buf->len > 0) {
+        memcpy(result, buf->data, buf->len);
+    }
+    buf_free(buf);
+    return result;
+}
+
+// 把暂存的单元格编码为 MoonBit Bytes，出错时返回状态为出错的空批次
+static moonbit_bytes_t batch_finish(batch_builder* batch, int status, const char** names) {
+    byte_buf out = {0};
+    if (!batch_encode(batch, status, names, &out)) {
+        buf_free(&out);
+        return batch_empty(2);
+    }
+    return buf_take_bytes(&out);
+}
+
+// 规范化每批的最大行数
+static int batch_rows_limit(int max_rows) {
+    if (max_rows <= 0) {
+        return DEFAULT_BATCH_ROWS;
+    }
+    return max_rows > MAX_BATCH_ROWS ? MAX_BATCH_ROWS : max_rows;
+}
+
+// ========== 类型化参数 ==========
+//
+// MoonBit 侧（SqlParam.mbt 的 encode_params）把参数打包为一段字节：
+//
+//   u32      参数个数（小端）
+//   每个参数：1 字节类型 + 值
+//     0 NULL
+//     1 整数：8 字节小端 Int64
+//     2 浮点数：8 字节小端 Double
+//     3 布尔：1 字节
+//     4 文本：u32 字节数 + UTF-8
+//     5 二进制：u32 字节数 + 字节
+//
+// 批量执行时为 u32 组数，随后依次是每组参数（格式同上）。
+
+#define PARAM_NULL 0
+#define PARAM_INT 1
+#define PARAM_REAL 2
+#define PARAM_BOOL 3
+#define PARAM_TEXT 4
+#define PARAM_BLOB 5
+
+typedef struct {
+    int type;
+    int64_t int_value;    // 整数和布尔值
+    double real_value;
+    const uint8_t* data;  // 文本和二进制（指向参数缓冲区，调用期间有效）
+    uint32_t len;
+} param_value;
+
+typedef struct {
+    const uint8_t* pos;
+    const uint8_t* end;
+} param_reader;
+
+static uint64_t read_le(const uint8_t* data, int size) {
+    uint64_t value = 0;
+    for (int i = 0; i < size; i++) {
+        value |= (uint64_t)data[i] << (8 * i);
+    }
+    return value;
+}
+
+static void param_init_range(param_reader* reader, const uint8_t* data, size_t len) {
+    reader->pos = data;
+    reader->end = data + len;
+}
+
+static void param_init(param_reader* reader, moonbit_bytes_t params) {
+    param_init_range(reader, params, params == NULL ? 0 : Moonbit_array_length(params));
+}
+
+// 读取一个 u32 个数（参数个数或批量执行的组数），格式错误时返回 -1
+static int param_count(param_reader* reader) {
+    if (reader->end - reader->pos < 4) {
+        return -1;
+    }
+    uint32_t count = (uint32_t)read_le(reader->pos, 4);
+    reader->pos += 4;
+    // 每个参数至少占 1 字节
+    return count <= (size_t)(reader->end - reader->pos) ? (int)count : -1;
+}
+
+// 开始读取参数，返回参数个数（空字节表示没有参数），格式错误时返回 -1
+static int param_begin(param_reader* reader, moonbit_bytes_t params) {
+    param_init(reader, params);
+    return reader->pos == reader->end ? 0 : param_count(reader);
+}
+
+// 读取下一个参数，格式错误时返回 0
+static int param_next(param_reader* reader, param_value* value) {
+    if (reader->pos >= reader->end) {
+        return 0;
+    }
+    memset(value, 0, sizeof(*value));
+    value->type = *reader->pos++;
+    size_t left = (size_t)(reader->end - reader->pos);
+    switch (value->type) {
+        case PARAM_NULL:
+            return 1;
+        case PARAM_INT:
+        case PARAM_REAL: {
+            if (left < 8) {
+                return 0;
+            }
+            uint64_t bits = read_le(reader->pos, 8);
+            reader->pos += 8;
+            if (value->type == PARAM_INT) {
+                value->int_value = (int64_t)bits;
+            } else {
+                memcpy(&value->real_value, &bits, 8);
+            }
+            return 1;
+        }
+        case PARAM_BOOL:
+            if (left < 1) {
+                return 0;
+            }
+            value->int_value = *reader->pos++ != 0;
+            return 1;
+        case PARAM_TEXT:
+        case PARAM_BLOB:
+            if (left < 4) {
+                return 0;
+            }
+            value->len = (uint32_t)read_le(reader->pos, 4);
+            reader->pos += 4;
+            if (value->len > left - 4) {
+                return 0;
+            }
+            value->data = reader->pos;
+            reader->pos += value->len;
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// 按类型绑定一组参数（文本和二进制由 SQLite 复制），参数个数与占位符个数不一致时返回 SQLITE_RANGE
+static int bind_param_list(sqlite3_stmt* stmt, param_reader* reader, int count) {
+    if (count < 0) {
+        return SQLITE_MISUSE;
+    }
+    if (count != sqlite3_bind_parameter_count(stmt)) {
+        return SQLITE_RANGE;
+    }
+    for (int i = 0; i < count; i++) {
+        param_value value;
+        if (!param_next(reader, &value)) {
+            return SQLITE_MISUSE;
+        }
+        int rc;
+        switch (value.type) {
+            case PARAM_INT:
+                rc = sqlite3_bind_int64(stmt, i + 1, (sqlite3_int64)value.int_value);
+                break;
+            case PARAM_REAL:
+                rc = sqlite3_bind_double(stmt, i + 1, value.real_value);
+                break;
+            case PARAM_BOOL:
+                rc = sqlite3_bind_int(stmt, i + 1, (int)value.int_value);
+                break;
+            case PARAM_TEXT:
+                rc = sqlite3_bind_text(stmt, i + 1, (const char*)value.data, (int)value.len, SQLITE_TRANSIENT);
+                break;
+            case PARAM_BLOB:
+                rc = sqlite3_bind_blob(stmt, i + 1, value.data, (int)value.len, SQLITE_TRANSIENT);
+                break;
+            default:
+                rc = sqlite3_bind_null(stmt, i + 1);
+                break;
+        }
+        if (rc != SQLITE_OK) {
+            return rc;
+        }
+    }
+    return SQLITE_OK;
+}
+
+static int bind_params(sqlite3_stmt* stmt, moonbit_bytes_t params) {
+    param_reader reader;
+    int count = param_begin(&reader, params);
+    return bind_param_list(stmt, &reader, count);
+}
+
+// 批量执行的结果：每组参数影响的行数（u32 小端）
+static moonbit_bytes_t counts_bytes(const int* counts, int n) {
+    moonbit_bytes_t bytes = moonbit_make_bytes(n * 4, 0);
+    for (int i = 0; i < n; i++) {
+        for (int k = 0; k < 4; k++) {
+            bytes[i * 4 + k] = (uint8_t)((uint32_t)counts[i] >> (8 * k));
+        }
+    }
+    return bytes;
+}
+
 // UTF-16 到 UTF-8 转换缓冲区（静态分配，避免内存泄漏）
 static char utf8_buffer[4096];
 
@@ -162,10 +795,135 @@ int autumn_sqlite3_exec(int handle, moonbit_string_t sql) {
     return rc;
 }
 
-/// SQLite 执行带参数的 SQL（简化实现：暂时不支持）
+/// SQLite 执行预编译的 SQL（通过语句缓存复用预编译结果）
+///
+/// 参数暂未传递到 C 侧（params 未使用），多条语句的 SQL 退回 sqlite3_exec
 int autumn_sqlite3_exec_prepared(int handle, moonbit_string_t sql, void* params) {
-    // 暂时不支持参数，直接执行 SQL
-    return autumn_sqlite3_exec(handle, sql);
+    sqlite3* db = get_db(handle);
+    if (db == NULL) {
+        return -1;
+    }
+
+    const char* sql_str = get_c_string(sql);
+    int cached = 0;
+    sqlite3_stmt* stmt = stmt_cache_acquire(handle, db, sql_str, &cached);
+    if (stmt == NULL) {
+        return sqlite3_errcode(db);
+    }
+    if (!cached) {
+        sqlite3_finalize(stmt);
+        return autumn_sqlite3_exec(handle, sql);
+    }
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+    }
+    stmt_cache_release(stmt, cached);
+    return rc == SQLITE_DONE ? SQLITE_OK : rc;
+}
+
+// 执行一条带参数的 SQL（通过语句缓存），没有参数的多语句 SQL 整体交给 sqlite3_exec
+static int exec_param_list(int handle, sqlite3* db, const char* sql, param_reader* reader, int count) {
+    int cached = 0;
+    sqlite3_stmt* stmt = stmt_cache_acquire(handle, db, sql, &cached);
+    if (stmt == NULL) {
+        return sqlite3_errcode(db);
+    }
+    if (!cached && count == 0) {
+        sqlite3_finalize(stmt);
+        return sqlite3_exec(db, sql, NULL, NULL, NULL);
+    }
+
+    int rc = bind_param_list(stmt, reader, count);
+    if (rc == SQLITE_OK) {
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        }
+        if (rc == SQLITE_DONE) {
+            rc = SQLITE_OK;
+        }
+    }
+    stmt_cache_release(stmt, cached);
+    return rc;
+}
+
+/// SQLite 执行带类型化参数的 SQL（通过语句缓存复用预编译结果）
+/// 
+/// 参数：
+/// - handle: 数据库连接句柄 ID
+/// - sql: SQL 语句（使用 ? 作为占位符）
+/// - params: 打包的参数（格式见“类型化参数”一节）
+/// 
+/// 返回：
+/// - 0: 成功
+/// - 非0: 错误代码（参数个数与占位符不一致时为 SQLITE_RANGE）
+int autumn_sqlite3_exec_params(int handle, moonbit_string_t sql, moonbit_bytes_t params) {
+    sqlite3* db = get_db(handle);
+    if (db == NULL) {
+        return -1;
+    }
+    param_reader reader;
+    int count = param_begin(&reader, params);
+    return exec_param_list(handle, db, get_c_string(sql), &reader, count);
+}
+
+/// SQLite 批量执行同一条 SQL（整批共用一个预编译语句和一个事务）
+/// 
+/// 整批包在保存点中：不在事务中时相当于 BEGIN ... COMMIT，只在最后提交一次；
+/// 已在外层事务中时失败只回滚本批。
+/// 
+/// 参数：
+/// - handle: 数据库连接句柄 ID
+/// - sql: 单条 SQL 语句（使用 ? 作为占位符）
+/// - batch: 打包的多组参数（格式见“类型化参数”一节）
+/// 
+/// 返回：
+/// - 每组参数影响的行数（u32 小端数组）；任一组失败时回滚整批并返回空字节
+moonbit_bytes_t autumn_sqlite3_exec_batch(int handle, moonbit_string_t sql, moonbit_bytes_t batch) {
+    sqlite3* db = get_db(handle);
+    param_reader reader;
+    param_init(&reader, batch);
+    int rows = param_count(&reader);
+    if (db == NULL || rows <= 0) {
+        return counts_bytes(NULL, 0);
+    }
+    int* counts = malloc(rows * sizeof(int));
+    if (counts == NULL) {
+        return counts_bytes(NULL, 0);
+    }
+
+    const char* sql_str = get_c_string(sql);
+    int cached = 0;
+    sqlite3_stmt* stmt = stmt_cache_acquire(handle, db, sql_str, &cached);
+    int rc = stmt == NULL ? sqlite3_errcode(db) : sqlite3_exec(db, "SAVEPOINT autumn_batch", NULL, NULL, NULL);
+    int in_savepoint = rc == SQLITE_OK;
+    for (int i = 0; rc == SQLITE_OK && i < rows; i++) {
+        sqlite3_reset(stmt);
+        rc = bind_param_list(stmt, &reader, param_count(&reader));
+        if (rc == SQLITE_OK) {
+            while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            }
+        }
+        if (rc == SQLITE_DONE) {
+            rc = SQLITE_OK;
+            counts[i] = sqlite3_changes(db);
+        }
+    }
+    if (stmt != NULL) {
+        stmt_cache_release(stmt, cached);
+    }
+    if (in_savepoint) {
+        if (rc == SQLITE_OK) {
+            rc = sqlite3_exec(db, "RELEASE autumn_batch", NULL, NULL, NULL);
+        }
+        if (rc != SQLITE_OK) {
+            sqlite3_exec(db, "ROLLBACK TO autumn_batch", NULL, NULL, NULL);
+            sqlite3_exec(db, "RELEASE autumn_batch", NULL, NULL, NULL);
+        }
+    }
+
+    moonbit_bytes_t result = counts_bytes(counts, rc == SQLITE_OK ? rows : 0);
+    free(counts);
+    return result;
 }
 
 /// SQLite 查询数据（实现完整的查询功能）
@@ -189,14 +947,12 @@ void** autumn_sqlite3_query(int handle, moonbit_string_t sql, void* params) {
     // 转换 SQL 字符串
     const char* sql_str = get_c_string(sql);
     
-    // 准备 SQL 语句
-    sqlite3_stmt* stmt = NULL;
-    int rc = sqlite3_prepare_v2(db, sql_str, -1, &stmt, NULL);
+    // 获取预编译语句（命中缓存时不重新 prepare）
+    int cached = 0;
+    sqlite3_stmt* stmt = stmt_cache_acquire(handle, db, sql_str, &cached);
+    int rc;
     
-    if (rc != SQLITE_OK) {
-        if (stmt != NULL) {
-            sqlite3_finalize(stmt);
-        }
+    if (stmt == NULL) {
         return results;
     }
     
@@ -251,8 +1007,8 @@ void** autumn_sqlite3_query(int handle, moonbit_string_t sql, void* params) {
         row_strings[row_count++] = row_str;
     }
     
-    // 释放语句
-    sqlite3_finalize(stmt);
+    // 归还语句（缓存中的语句只 reset）
+    stmt_cache_release(stmt, cached);
     
     // 如果没有结果，返回空数组
     if (row_count == 0) {
@@ -276,6 +1032,586 @@ void** autumn_sqlite3_query(int handle, moonbit_string_t sql, void* params) {
     return array_elements;
 }
 
+// ========== 流式游标 ==========
+//
+// 游标持有自己的语句（不使用语句缓存：同一条 SQL 在游标打开期间再次执行时，
+// 缓存中的语句会被 reset，游标的读取位置就丢失了）。
+
+#define MAX_CURSORS 64
+
+typedef struct {
+    int handle;           // 所属连接，-1 表示空槽位
+    sqlite3_stmt* stmt;   // 游标的语句
+    int done;             // 0 读取中，1 结果集已读完，2 出错
+} sqlite_cursor;
+
+static sqlite_cursor cursors[MAX_CURSORS];
+static int cursors_initialized = 0;
+
+static sqlite_cursor* get_cursor(int cursor) {
+    if (cursor >= 0 && cursor < MAX_CURSORS && cursors_initialized && cursors[cursor].handle >= 0) {
+        return &cursors[cursor];
+    }
+    return NULL;
+}
+
+static void cursor_release(sqlite_cursor* cursor) {
+    sqlite3_finalize(cursor->stmt);
+    cursor->stmt = NULL;
+    cursor->handle = -1;
+    cursor->done = 0;
+}
+
+// 关闭连接上所有未关闭的游标（关闭连接前调用）
+static void cursor_close_all(int handle) {
+    for (int i = 0; cursors_initialized && i < MAX_CURSORS; i++) {
+        if (cursors[i].handle == handle) {
+            cursor_release(&cursors[i]);
+        }
+    }
+}
+
+/// SQLite 打开流式游标（适配 MoonBit FFI）
+/// 
+/// 参数：
+/// - handle: 数据库连接句柄 ID
+/// - sql: SQL 查询语句（MoonBit String）
+/// - params: 打包的参数（格式见“类型化参数”一节）
+/// 
+/// 返回：
+/// - >= 0: 游标 ID
+/// - < 0: 失败（连接无效、SQL 错误、参数不匹配或游标表已满）
+int autumn_sqlite3_cursor_open(int handle, moonbit_string_t sql, moonbit_bytes_t params) {
+    sqlite3* db = get_db(handle);
+    if (db == NULL) {
+        return -1;
+    }
+    if (!cursors_initialized) {
+        for (int i = 0; i < MAX_CURSORS; i++) {
+            cursors[i].handle = -1;
+        }
+        cursors_initialized = 1;
+    }
+    int slot = -1;
+    for (int i = 0; i < MAX_CURSORS; i++) {
+        if (cursors[i].handle < 0) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) {
+        return -1;
+    }
+
+    sqlite3_stmt* stmt = NULL;
+    if (sqlite3_prepare_v2(db, get_c_string(sql), -1, &stmt, NULL) != SQLITE_OK || stmt == NULL) {
+        if (stmt != NULL) {
+            sqlite3_finalize(stmt);
+        }
+        return -1;
+    }
+    if (bind_params(stmt, params) != SQLITE_OK) {
+        sqlite3_finalize(stmt);
+        return -1;
+    }
+    cursors[slot].handle = handle;
+    cursors[slot].stmt = stmt;
+    cursors[slot].done = 0;
+    return slot;
+}
+
+// 读取最多 limit 行写入批次，返回批次状态：0 可能还有后续行，1 结果集已读完，2 出错
+static int batch_step_rows(sqlite3_stmt* stmt, batch_builder* batch, int limit) {
+    int columns = sqlite3_column_count(stmt);
+    while (batch->rows < limit && !batch->failed) {
+        int rc = sqlite3_step(stmt);
+        if (rc == SQLITE_DONE) {
+            return 1;
+        }
+        if (rc != SQLITE_ROW) {
+            return 2;
+        }
+        for (int i = 0; i < columns; i++) {
+            switch (sqlite3_column_type(stmt, i)) {
+                case SQLITE_INTEGER:
+                    batch_int(batch, i, (int64_t)sqlite3_column_int64(stmt, i));
+                    break;
+                case SQLITE_FLOAT:
+                    batch_real(batch, i, sqlite3_column_double(stmt, i));
+                    break;
+                case SQLITE_TEXT: {
+                    const unsigned char* text = sqlite3_column_text(stmt, i);
+                    batch_bytes(batch, i, CELL_TEXT, text, (size_t)sqlite3_column_bytes(stmt, i));
+                    break;
+                }
+                case SQLITE_BLOB: {
+                    const void* blob = sqlite3_column_blob(stmt, i);
+                    batch_bytes(batch, i, CELL_BLOB, blob, (size_t)sqlite3_column_bytes(stmt, i));
+                    break;
+                }
+                default:
+                    batch_null(batch, i);
+                    break;
+            }
+        }
+        batch_end_row(batch);
+    }
+    return 0;
+}
+
+static void batch_column_names(sqlite3_stmt* stmt, const char** names) {
+    int columns = sqlite3_column_count(stmt);
+    for (int i = 0; i < columns; i++) {
+        names[i] = sqlite3_column_name(stmt, i);
+    }
+}
+
+/// SQLite 从游标读取下一批行（适配 MoonBit FFI）
+/// 
+/// 参数：
+/// - cursor: 游标 ID
+/// - max_rows: 本批最多读取的行数（<= 0 时使用默认值 256）
+/// 
+/// 返回：
+/// - 列式批次（格式见“列式结果批次”一节）；游标无效时返回状态为出错的空批次
+moonbit_bytes_t autumn_sqlite3_cursor_fetch(int cursor, int max_rows) {
+    sqlite_cursor* entry = get_cursor(cursor);
+    if (entry == NULL) {
+        return batch_empty(2);
+    }
+    sqlite3_stmt* stmt = entry->stmt;
+    int columns = sqlite3_column_count(stmt);
+    int limit = batch_rows_limit(max_rows);
+
+    batch_builder batch;
+    if (!batch_init(&batch, columns)) {
+        return batch_empty(2);
+    }
+    int status = entry->done;
+    if (!entry->done) {
+        status = batch_step_rows(stmt, &batch, limit);
+        entry->done = status;
+    }
+
+    const char* names[columns > 0 ? columns : 1];
+    batch_column_names(stmt, names);
+    moonbit_bytes_t result = batch_finish(&batch, status, names);
+    batch_free(&batch);
+    return result;
+}
+
+/// SQLite 关闭游标（适配 MoonBit FFI）
+/// 
+/// 返回：
+/// - 0: 成功
+/// - -1: 游标无效（已关闭）
+int autumn_sqlite3_cursor_close(int cursor) {
+    sqlite_cursor* entry = get_cursor(cursor);
+    if (entry == NULL) {
+        return -1;
+    }
+    cursor_release(entry);
+    return 0;
+}
+
+// ========== 后台工作线程池 ==========
+//
+// 异步接口让事件循环（AsyncServer）不被阻塞的数据库调用卡住：
+// 提交时把 SQL 和打包参数复制到 C 堆上排队，由工作线程执行，
+// 结果编码为列式批次暂存在任务中；调用方轮询任务状态（或等待 eventfd 可读）后再取回。
+//
+// - 同一连接上的任务按提交顺序串行执行，不同连接上的任务并行执行
+// - 工作线程不接触 MoonBit 对象，MoonBit Bytes 只在取回结果时由调用线程创建
+// - 连接上还有未完成的任务时，调用方不能再同步使用这个连接；关闭连接会先等待这些任务完成
+//
+// 查询任务的结果是包含全部行的批次（状态 1）；执行任务的结果是空批次，状态 1 成功、2 出错。
+
+#define MAX_JOBS 256
+#define DEFAULT_WORKERS 4
+#define MAX_WORKERS 64
+
+#define JOB_FREE 0
+#define JOB_QUEUED 1
+#define JOB_RUNNING 2
+#define JOB_DONE 3
+
+typedef struct async_job {
+    int state;
+    int handle;
+    void* conn;           // 连接（提交时取出，工作线程不再查句柄表）
+    int query;            // 1 查询，0 执行
+    int discarded;        // 调用方已放弃，执行完直接回收
+    char* sql;
+    uint8_t* params;      // 打包参数的副本
+    size_t params_len;
+    byte_buf result;      // 编码好的列式批次
+    struct async_job* next;
+} async_job;
+
+static async_job jobs[MAX_JOBS];
+static async_job* queue_head = NULL;
+static async_job* queue_tail = NULL;
+static int handle_busy[MAX_HANDLES];
+static pthread_mutex_t jobs_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobs_changed = PTHREAD_COND_INITIALIZER;
+static int worker_count = 0;
+static int event_fd = -1;
+
+// 由各包装层实现：工作线程初始化、执行一个任务
+static void async_worker_init(void);
+static void async_run(async_job* job);
+
+static void job_reset(async_job* job) {
+    free(job->sql);
+    free(job->params);
+    buf_free(&job->result);
+    memset(job, 0, sizeof(*job));
+}
+
+// 从队列中摘下任务（调用时持有 jobs_lock）
+static void async_unlink(async_job* target) {
+    async_job* prev = NULL;
+    for (async_job* job = queue_head; job != NULL; prev = job, job = job->next) {
+        if (job == target) {
+            if (prev == NULL) {
+                queue_head = job->next;
+            } else {
+                prev->next = job->next;
+            }
+            if (queue_tail == job) {
+                queue_tail = prev;
+            }
+            job->next = NULL;
+            return;
+        }
+    }
+}
+
+// 取出第一个所属连接空闲的任务（调用时持有 jobs_lock）
+// 同一连接的任务在队列中保持提交顺序，所以取到的总是该连接最早的任务
+static async_job* async_dequeue(void) {
+    for (async_job* job = queue_head; job != NULL; job = job->next) {
+        if (!handle_busy[job->handle]) {
+            async_unlink(job);
+            return job;
+        }
+    }
+    return NULL;
+}
+
+static void* async_worker(void* arg) {
+    (void)arg;
+    async_worker_init();
+    pthread_mutex_lock(&jobs_lock);
+    for (;;) {
+        async_job* job = async_dequeue();
+        if (job == NULL) {
+            pthread_cond_wait(&jobs_changed, &jobs_lock);
+            continue;
+        }
+        job->state = JOB_RUNNING;
+        handle_busy[job->handle] = 1;
+        pthread_mutex_unlock(&jobs_lock);
+
+        async_run(job);
+
+        pthread_mutex_lock(&jobs_lock);
+        handle_busy[job->handle] = 0;
+        if (job->discarded) {
+            job_reset(job);
+        } else {
+            job->state = JOB_DONE;
+        }
+        // 唤醒等待同一连接的工作线程和 async_wait_idle
+        pthread_cond_broadcast(&jobs_changed);
+        if (event_fd >= 0) {
+            uint64_t one = 1;
+            ssize_t written = write(event_fd, &one, sizeof(one));
+            (void)written;
+        }
+    }
+    return NULL;
+}
+
+// 启动工作线程（调用时持有 jobs_lock），已启动时不再增加，返回工作线程数
+static int async_start_locked(int threads) {
+    if (worker_count > 0) {
+        return worker_count;
+    }
+    if (threads <= 0) {
+        threads = DEFAULT_WORKERS;
+    }
+    if (threads > MAX_WORKERS) {
+        threads = MAX_WORKERS;
+    }
+    if (event_fd < 0) {
+        event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, async_worker, NULL) != 0) {
+            break;
+        }
+        pthread_detach(thread);
+        worker_count++;
+    }
+    return worker_count;
+}
+
+// 复制 SQL 和参数并排队，返回任务 ID，失败时返回 -1（在调用线程中使用）
+static int async_submit(int handle, void* conn, const char* sql, moonbit_bytes_t params, int query) {
+    size_t len = params == NULL ? 0 : Moonbit_array_length(params);
+    char* sql_copy = strdup(sql);
+    uint8_t* params_copy = len > 0 ? (uint8_t*)malloc(len) : NULL;
+    if (sql_copy == NULL || (len > 0 && params_copy == NULL)) {
+        free(sql_copy);
+        free(params_copy);
+        return -1;
+    }
+    if (len > 0) {
+        memcpy(params_copy, params, len);
+    }
+
+    pthread_mutex_lock(&jobs_lock);
+    int slot = -1;
+    if (async_start_locked(0) > 0) {
+        for (int i = 0; i < MAX_JOBS; i++) {
+            if (jobs[i].state == JOB_FREE) {
+                slot = i;
+                break;
+            }
+        }
+    }
+    if (slot < 0) {
+        pthread_mutex_unlock(&jobs_lock);
+        free(sql_copy);
+        free(params_copy);
+        return -1;
+    }
+    async_job* job = &jobs[slot];
+    job->state = JOB_QUEUED;
+    job->handle = handle;
+    job->conn = conn;
+    job->query = query;
+    job->sql = sql_copy;
+    job->params = params_copy;
+    job->params_len = len;
+    if (queue_tail == NULL) {
+        queue_head = job;
+    } else {
+        queue_tail->next = job;
+    }
+    queue_tail = job;
+    pthread_cond_broadcast(&jobs_changed);
+    pthread_mutex_unlock(&jobs_lock);
+    return slot;
+}
+
+static async_job* get_job(int job) {
+    if (job >= 0 && job < MAX_JOBS && jobs[job].state != JOB_FREE && !jobs[job].discarded) {
+        return &jobs[job];
+    }
+    return NULL;
+}
+
+// 返回 1 已完成，0 排队或执行中，-1 任务无效
+static int async_poll(int id) {
+    pthread_mutex_lock(&jobs_lock);
+    async_job* job = get_job(id);
+    int result = job == NULL ? -1 : job->state == JOB_DONE;
+    pthread_mutex_unlock(&jobs_lock);
+    return result;
+}
+
+// 取回已完成任务的结果并回收任务，任务无效或未完成时返回状态为出错的空批次
+static moonbit_bytes_t async_take(int id) {
+    pthread_mutex_lock(&jobs_lock);
+    async_job* job = get_job(id);
+    if (job == NULL || job->state != JOB_DONE) {
+        pthread_mutex_unlock(&jobs_lock);
+        return batch_empty(2);
+    }
+    byte_buf result = job->result;
+    memset(&job->result, 0, sizeof(job->result));
+    job_reset(job);
+    pthread_mutex_unlock(&jobs_lock);
+    if (result.len == 0) {
+        buf_free(&result);
+        return batch_empty(2);
+    }
+    return buf_take_bytes(&result);
+}
+
+// 放弃任务：排队中的直接移除，执行中的等执行完再回收，返回 -1 表示任务无效
+static int async_discard(int id) {
+    pthread_mutex_lock(&jobs_lock);
+    async_job* job = get_job(id);
+    if (job == NULL) {
+        pthread_mutex_unlock(&jobs_lock);
+        return -1;
+    }
+    if (job->state == JOB_RUNNING) {
+        job->discarded = 1;
+    } else {
+        if (job->state == JOB_QUEUED) {
+            async_unlink(job);
+        }
+        job_reset(job);
+        pthread_cond_broadcast(&jobs_changed);
+    }
+    pthread_mutex_unlock(&jobs_lock);
+    return 0;
+}
+
+static int async_pending(int handle) {
+    for (int i = 0; i < MAX_JOBS; i++) {
+        if (jobs[i].handle == handle && (jobs[i].state == JOB_QUEUED || jobs[i].state == JOB_RUNNING)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 等待连接上排队和执行中的任务全部完成（关闭连接前调用）
+static void async_wait_idle(int handle) {
+    pthread_mutex_lock(&jobs_lock);
+    while (async_pending(handle)) {
+        pthread_cond_wait(&jobs_changed, &jobs_lock);
+    }
+    pthread_mutex_unlock(&jobs_lock);
+}
+
+static int async_event_fd(void) {
+    pthread_mutex_lock(&jobs_lock);
+    async_start_locked(0);
+    int fd = event_fd;
+    pthread_mutex_unlock(&jobs_lock);
+    return fd;
+}
+
+// 开始读取任务的参数，返回参数个数（没有参数时为 0），格式错误时返回 -1
+static int async_params(async_job* job, param_reader* reader) {
+    param_init_range(reader, job->params, job->params_len);
+    return reader->pos == reader->end ? 0 : param_count(reader);
+}
+
+// 任务结果为只有状态的空批次
+static void async_result_status(async_job* job, int status) {
+    buf_free(&job->result);
+    buf_byte(&job->result, (uint8_t)status);
+    buf_u32(&job->result, 0);
+    buf_u32(&job->result, 0);
+}
+
+static void async_worker_init(void) {
+}
+
+// 在工作线程中执行任务，结果写入 job->result
+static void async_run(async_job* job) {
+    sqlite3* db = (sqlite3*)job->conn;
+    param_reader reader;
+    int count = async_params(job, &reader);
+    if (!job->query) {
+        int rc = exec_param_list(job->handle, db, job->sql, &reader, count);
+        async_result_status(job, rc == SQLITE_OK ? 1 : 2);
+        return;
+    }
+
+    sqlite3_stmt* stmt = NULL;
+    if (sqlite3_prepare_v2(db, job->sql, -1, &stmt, NULL) != SQLITE_OK || stmt == NULL
+        || bind_param_list(stmt, &reader, count) != SQLITE_OK) {
+        sqlite3_finalize(stmt);
+        async_result_status(job, 2);
+        return;
+    }
+    int columns = sqlite3_column_count(stmt);
+    batch_builder batch;
+    int status = 2;
+    if (batch_init(&batch, columns)) {
+        status = batch_step_rows(stmt, &batch, INT_MAX);
+        const char* names[columns > 0 ? columns : 1];
+        batch_column_names(stmt, names);
+        if (status != 1 || !batch_encode(&batch, status, names, &job->result)) {
+            status = 2;
+        }
+        batch_free(&batch);
+    }
+    sqlite3_finalize(stmt);
+    if (status != 1) {
+        async_result_status(job, 2);
+    }
+}
+
+/// SQLite 启动后台工作线程（适配 MoonBit FFI）
+/// 
+/// 参数：
+/// - threads: 工作线程数，<= 0 时使用默认值；已启动时忽略
+/// 
+/// 返回：
+/// - 工作线程数，0 表示无法创建线程
+int autumn_sqlite3_async_start(int threads) {
+    pthread_mutex_lock(&jobs_lock);
+    int count = async_start_locked(threads);
+    pthread_mutex_unlock(&jobs_lock);
+    return count;
+}
+
+/// SQLite 提交异步任务，由工作线程执行（适配 MoonBit FFI）
+/// 
+/// 参数：
+/// - handle: 数据库连接句柄 ID
+/// - sql: SQL 语句（使用 ? 作为占位符）
+/// - params: 打包的参数（格式见“类型化参数”一节）
+/// - query: 1 查询（结果为全部行），0 执行
+/// 
+/// 返回：
+/// - >= 0: 任务 ID
+/// - -1: 失败（连接无效或任务表已满）
+int autumn_sqlite3_async_submit(int handle, moonbit_string_t sql, moonbit_bytes_t params, int query) {
+    sqlite3* db = get_db(handle);
+    if (db == NULL) {
+        return -1;
+    }
+    return async_submit(handle, db, get_c_string(sql), params, query);
+}
+
+/// SQLite 查询异步任务状态（适配 MoonBit FFI）
+/// 
+/// 返回：
+/// - 1: 已完成，可以取回结果
+/// - 0: 排队或执行中
+/// - -1: 任务无效
+int autumn_sqlite3_async_poll(int job) {
+    return async_poll(job);
+}
+
+/// SQLite 取回异步任务的结果并释放任务（适配 MoonBit FFI）
+/// 
+/// 返回：
+/// - 列式批次（格式见“列式结果批次”一节）；任务无效或未完成时返回状态为出错的空批次
+moonbit_bytes_t autumn_sqlite3_async_take(int job) {
+    return async_take(job);
+}
+
+/// SQLite 放弃异步任务（适配 MoonBit FFI）
+/// 
+/// 返回：
+/// - 0: 成功（执行中的任务完成后释放）
+/// - -1: 任务无效
+int autumn_sqlite3_async_discard(int job) {
+    return async_discard(job);
+}
+
+/// SQLite 获取任务完成通知的 eventfd（适配 MoonBit FFI）
+/// 
+/// 每完成一个任务计数加 1，可以交给支持文件描述符的事件循环等待可读
+/// 
+/// 返回：
+/// - 文件描述符，-1 表示不可用
+int autumn_sqlite3_async_event_fd(void) {
+    return async_event_fd();
+}
+
 /// SQLite 关闭数据库连接（适配 MoonBit FFI）
 /// 
 /// 参数：
@@ -290,11 +1626,37 @@ int autumn_sqlite3_close(int handle) {
         return -1;
     }
     
+    // 先等后台任务完成，再释放游标和缓存的语句，否则 sqlite3_close 返回 SQLITE_BUSY
+    async_wait_idle(handle);
+    cursor_close_all(handle);
+    stmt_cache_clear(handle);
     int rc = sqlite3_close(db);
     remove_db(handle);
     return rc;
 }
 
+/// SQLite 获取语句缓存的统计信息（适配 MoonBit FFI）
+/// 
+/// 参数：
+/// - handle: 数据库连接句柄 ID
+/// - stat: 0 命中次数，1 未命中次数，2 当前条目数，3 淘汰次数
+/// 
+/// 返回：
+/// - 统计值，句柄无效时返回 -1
+int autumn_sqlite3_stmt_cache_stat(int handle, int stat) {
+    if (get_db(handle) == NULL) {
+        return -1;
+    }
+    stmt_cache* cache = &stmt_caches[handle];
+    switch (stat) {
+        case 0: return cache->hits;
+        case 1: return cache->misses;
+        case 2: return cache->size;
+        case 3: return cache->evictions;
+        default: return -1;
+    }
+}
+
 /// SQLite 获取最后的错误信息（适配 MoonBit FFI）
 /// 
 /// 参数：
@@ -325,3 +1687,36 @@ moonbit_string_t autumn_sqlite3_errmsg(int handle) {
     
     return result;
 }
+
+/// SQLite 获取最后的错误码（主错误码，适配 MoonBit FFI）
+/// 
+/// 参数：
+/// - handle: 数据库连接句柄 ID
+/// 
+/// 返回：
+/// - SQLITE_* 主错误码（扩展错误码的低 8 位），句柄无效时返回 -1
+int autumn_sqlite3_errcode(int handle) {
+    sqlite3* db = get_db(handle);
+    if (db == NULL) {
+        return -1;
+    }
+    return sqlite3_extended_errcode(db) & 0xff;
+}
+
+/// SQLite 获取连接打开以来累计修改的行数（适配 MoonBit FFI）
+/// 
+/// 与 sqlite3_changes 不同，DDL 和查询不会让结果停留在上一条 DML 的行数上，
+/// 执行前后两次调用之差就是其间语句修改的行数
+/// 
+/// 参数：
+/// - handle: 数据库连接句柄 ID
+/// 
+/// 返回：
+/// - 累计修改的行数，句柄无效时返回 -1
+int autumn_sqlite3_total_changes(int handle) {
+    sqlite3* db = get_db(handle);
+    if (db == NULL) {
+        return -1;
+    }
+    return sqlite3_total_changes(db);
+}
@@ -0,0 +1,803 @@
+// loadgen - Autumn 服务器的 HTTP 压测工具
+//
+// 在本机回环地址上打开 N 个 keep-alive 连接，按权重重放请求组合，
+// 统计吞吐量、延迟分位数和错误率，并以 JSON 输出，便于对比
+// EmbeddedServer 与 AsyncServer 或不同提交之间的性能。
+//
+// 编译：
+//   gcc -O2 -pthread -o loadgen/loadgen loadgen/loadgen.c
+//
+// 用法：
+//   loadgen/loadgen [-H host] [-p port] [-c connections] [-d seconds]
+//                   [-w warmup_seconds] [-m mix_file] [-o output.json]
+//
+// 请求组合文件每行一条请求，格式为：
+//   <权重> <方法> <路径> [请求体]
+// 以 # 开头的行和空行会被忽略。未指定时使用 autumn-demo 的默认路由组合。
+
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+// ========== 延迟直方图 ==========
+//
+// 与 Autumn-Metrics 的 LatencyHistogram 使用相同的桶布局：
+// 每个 2 的幂区间划分为 8 个子桶，单位为微秒，相对误差不超过 12.5%
+
+#define SUB_BUCKET_BITS 3
+#define SUB_BUCKET_COUNT 8
+#define MAX_EXPONENT 40
+#define BUCKET_COUNT \
+  (SUB_BUCKET_COUNT + (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT)
+
+typedef struct {
+  uint64_t counts[BUCKET_COUNT];
+  uint64_t total;
+  uint64_t sum;
+  uint64_t min;
+  uint64_t max;
+} histogram_t;
+
+static int bucket_index(uint64_t value) {
+  if (value < SUB_BUCKET_COUNT) {
+    return (int)value;
+  }
+  int exponent = 63 - __builtin_clzll(value);
+  if (exponent > MAX_EXPONENT) {
+    return BUCKET_COUNT - 1;
+  }
+  int shift = exponent - SUB_BUCKET_BITS;
+  int sub_bucket = (int)((value >> shift) & 7);
+  return SUB_BUCKET_COUNT + shift * SUB_BUCKET_COUNT + sub_bucket;
+}
+
+static uint64_t bucket_upper_bound(int index) {
+  if (index < SUB_BUCKET_COUNT) {
+    return (uint64_t)index;
+  }
+  int shift = (index - SUB_BUCKET_COUNT) / SUB_BUCKET_COUNT;
+  int sub_bucket = (index - SUB_BUCKET_COUNT) % SUB_BUCKET_COUNT;
+  uint64_t lower = (uint64_t)(SUB_BUCKET_COUNT + sub_bucket) << shift;
+  return lower + ((uint64_t)1 << shift) - 1;
+}
+
+static void histogram_record(histogram_t* h, uint64_t value) {
+  h->counts[bucket_index(value)]++;
+  if (h->total == 0 || value < h->min) {
+    h->min = value;
+  }
+  if (value > h->max) {
+    h->max = value;
+  }
+  h->total++;
+  h->sum += value;
+}
+
+static void histogram_merge(histogram_t* into, const histogram_t* from) {
+  if (from->total == 0) {
+    return;
+  }
+  for (int i = 0; i < BUCKET_COUNT; i++) {
+    into->counts[i] += from->counts[i];
+  }
+  if (into->total == 0 || from->min < into->min) {
+    into->min = from->min;
+  }
+  if (from->max > into->max) {
+    into->max = from->max;
+  }
+  into->total += from->total;
+  into->sum += from->sum;
+}
+
+static uint64_t histogram_percentile(const histogram_t* h, double q) {
+  if (h->total == 0) {
+    return 0;
+  }
+  uint64_t target = (uint64_t)(q * (double)h->total + 0.999999);
+  if (target < 1) {
+    target = 1;
+  }
+  uint64_t seen = 0;
+  for (int i = 0; i < BUCKET_COUNT; i++) {
+    seen += h->counts[i];
+    if (seen >= target) {
+      uint64_t upper = bucket_upper_bound(i);
+      return upper > h->max ? h->max : upper;
+    }
+  }
+  return h->max;
+}
+
+// ========== 请求组合 ==========
+
+typedef struct {
+  char* name;     // "METHOD PATH"，用于输出
+  char* raw;      // 完整的 HTTP 请求报文
+  size_t raw_len;
+  int weight;
+} request_spec_t;
+
+typedef struct {
+  request_spec_t* items;
+  int count;
+  int total_weight;
+} request_mix_t;
+
+static char* build_raw_request(const char* host, int port, const char* method,
+                               const char* path, const char* body,
+                               size_t* out_len) {
+  size_t body_len = body ? strlen(body) : 0;
+  size_t cap = strlen(method) + strlen(path) + strlen(host) + body_len + 256;
+  char* raw = malloc(cap);
+  if (!raw) {
+    return NULL;
+  }
+  int n;
+  if (body_len > 0) {
+    n = snprintf(raw, cap,
+                 "%s %s HTTP/1.1\r\n"
+                 "Host: %s:%d\r\n"
+                 "Connection: keep-alive\r\n"
+                 "Content-Type: application/json\r\n"
+                 "Content-Length: %zu\r\n"
+                 "\r\n"
+                 "%s",
+                 method, path, host, port, body_len, body);
+  } else {
+    n = snprintf(raw, cap,
+                 "%s %s HTTP/1.1\r\n"
+                 "Host: %s:%d\r\n"
+                 "Connection: keep-alive\r\n"
+                 "\r\n",
+                 method, path, host, port);
+  }
+  *out_len = (size_t)n;
+  return raw;
+}
+
+static int mix_add(request_mix_t* mix, const char* host, int port, int weight,
+                   const char* method, const char* path, const char* body) {
+  request_spec_t* items =
+      realloc(mix->items, sizeof(request_spec_t) * (size_t)(mix->count + 1));
+  if (!items) {
+    return -1;
+  }
+  mix->items = items;
+  request_spec_t* spec = &mix->items[mix->count];
+  size_t name_len = strlen(method) + strlen(path) + 2;
+  spec->name = malloc(name_len);
+  if (!spec->name) {
+    return -1;
+  }
+  snprintf(spec->name, name_len, "%s %s", method, path);
+  spec->raw = build_raw_request(host, port, method, path, body, &spec->raw_len);
+  if (!spec->raw) {
+    return -1;
+  }
+  spec->weight = weight;
+  mix->count++;
+  mix->total_weight += weight;
+  return 0;
+}
+
+// autumn-demo 的默认路由组合（读多写少）
+static int mix_load_default(request_mix_t* mix, const char* host, int port) {
+  if (mix_add(mix, host, port, 40, "GET", "/api/users", NULL) < 0 ||
+      mix_add(mix, host, port, 40, "GET", "/api/users/123", NULL) < 0 ||
+      mix_add(mix, host, port, 10, "POST", "/api/users",
+              "{\"name\":\"loadgen\",\"email\":\"loadgen@example.com\"}") < 0 ||
+      mix_add(mix, host, port, 10, "GET", "/", NULL) < 0) {
+    return -1;
+  }
+  return 0;
+}
+
+static int mix_load_file(request_mix_t* mix, const char* host, int port,
+                         const char* path) {
+  FILE* file = fopen(path, "r");
+  if (!file) {
+    fprintf(stderr, "loadgen: cannot open mix file %s: %s\n", path,
+            strerror(errno));
+    return -1;
+  }
+  char line[8192];
+  int line_no = 0;
+  while (fgets(line, sizeof(line), file)) {
+    line_no++;
+    line[strcspn(line, "\r\n")] = '\0';
+    char* p = line;
+    while (*p == ' ' || *p == '\t') {
+      p++;
+    }
+    if (*p == '\0' || *p == '#') {
+      continue;
+    }
+    char method[16];
+    char req_path[4096];
+    int weight = 0;
+    int consumed = 0;
+    if (sscanf(p, "%d %15s %4095s %n", &weight, method, req_path, &consumed) <
+            3 ||
+        weight <= 0) {
+      fprintf(stderr, "loadgen: %s:%d: expected '<weight> <method> <path> [body]'\n",
+              path, line_no);
+      fclose(file);
+      return -1;
+    }
+    const char* body = p + consumed;
+    if (mix_add(mix, host, port, weight, method, req_path,
+                *body ? body : NULL) < 0) {
+      fclose(file);
+      return -1;
+    }
+  }
+  fclose(file);
+  if (mix->count == 0) {
+    fprintf(stderr, "loadgen: mix file %s contains no requests\n", path);
+    return -1;
+  }
+  return 0;
+}
+
+// ========== 工作线程 ==========
+
+typedef struct {
+  uint64_t requests;     // 收到完整响应的请求数
+  uint64_t status[6];    // 状态码分类计数（下标 1~5 对应 1xx~5xx）
+  uint64_t connect_errors;
+  uint64_t io_errors;    // 发送/接收失败或对端提前关闭
+  uint64_t parse_errors; // 响应格式错误
+  uint64_t reconnects;
+  uint64_t bytes_in;
+  uint64_t bytes_out;
+} counters_t;
+
+typedef struct {
+  histogram_t latency;   // 所有请求的延迟（微秒）
+  histogram_t* by_spec;  // 每种请求的延迟
+  uint64_t* spec_counts;
+  counters_t counters;
+} stats_t;
+
+typedef struct {
+  int id;
+  const request_mix_t* mix;
+  struct sockaddr_storage addr;
+  socklen_t addr_len;
+  stats_t stats;
+  uint64_t rng;
+} worker_t;
+
+static atomic_int g_phase = 0;  // 0 = 预热, 1 = 测量, 2 = 结束
+
+static uint64_t now_micros(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static uint64_t xorshift64(uint64_t* state) {
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
+static const request_spec_t* pick_request(worker_t* w, int* index) {
+  int ticket = (int)(xorshift64(&w->rng) % (uint64_t)w->mix->total_weight);
+  for (int i = 0; i < w->mix->count; i++) {
+    ticket -= w->mix->items[i].weight;
+    if (ticket < 0) {
+      *index = i;
+      return &w->mix->items[i];
+    }
+  }
+  *index = w->mix->count - 1;
+  return &w->mix->items[*index];
+}
+
+static int open_connection(worker_t* w) {
+  int fd = socket(w->addr.ss_family, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  // 设置收发超时，避免服务器卡死时工作线程无法退出
+  struct timeval timeout = {.tv_sec = 5, .tv_usec = 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+  if (connect(fd, (struct sockaddr*)&w->addr, w->addr_len) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static int send_all(int fd, const char* data, size_t len) {
+  size_t sent = 0;
+  while (sent < len) {
+    ssize_t n = send(fd, data + sent, len - sent, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    sent += (size_t)n;
+  }
+  return 0;
+}
+
+// 响应读取缓冲区
+typedef struct {
+  char* data;
+  size_t len;
+  size_t cap;
+} buffer_t;
+
+static int buffer_reserve(buffer_t* buf, size_t extra) {
+  if (buf->len + extra <= buf->cap) {
+    return 0;
+  }
+  size_t cap = buf->cap ? buf->cap : 16384;
+  while (cap < buf->len + extra) {
+    cap *= 2;
+  }
+  char* data = realloc(buf->data, cap);
+  if (!data) {
+    return -1;
+  }
+  buf->data = data;
+  buf->cap = cap;
+  return 0;
+}
+
+static void buffer_consume(buffer_t* buf, size_t n) {
+  memmove(buf->data, buf->data + n, buf->len - n);
+  buf->len -= n;
+}
+
+// 在 [start, end) 中查找请求头（大小写不敏感），返回值的起始位置
+static const char* find_header(const char* start, const char* end,
+                               const char* name) {
+  size_t name_len = strlen(name);
+  const char* line = start;
+  while (line < end) {
+    const char* eol = memmem(line, (size_t)(end - line), "\r\n", 2);
+    if (!eol) {
+      eol = end;
+    }
+    if ((size_t)(eol - line) > name_len && line[name_len] == ':' &&
+        strncasecmp(line, name, name_len) == 0) {
+      const char* value = line + name_len + 1;
+      while (value < eol && (*value == ' ' || *value == '\t')) {
+        value++;
+      }
+      return value;
+    }
+    line = eol + 2;
+  }
+  return NULL;
+}
+
+typedef enum { READ_OK, READ_IO_ERROR, READ_PARSE_ERROR } read_result_t;
+
+// 读取一个完整响应，返回状态码、是否需要关闭连接及响应字节数
+static read_result_t read_response(int fd, buffer_t* buf, int* status,
+                                   int* should_close, size_t* bytes) {
+  size_t header_end = 0;
+  for (;;) {
+    if (buf->len >= 4) {
+      char* found = memmem(buf->data, buf->len, "\r\n\r\n", 4);
+      if (found) {
+        header_end = (size_t)(found - buf->data) + 4;
+        break;
+      }
+    }
+    if (buffer_reserve(buf, 16384) < 0) {
+      return READ_IO_ERROR;
+    }
+    ssize_t n = recv(fd, buf->data + buf->len, buf->cap - buf->len, 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return READ_IO_ERROR;
+    }
+    buf->len += (size_t)n;
+  }
+
+  if (header_end < 12 || strncmp(buf->data, "HTTP/1.", 7) != 0) {
+    return READ_PARSE_ERROR;
+  }
+  *status = atoi(buf->data + 9);
+  if (*status < 100 || *status > 599) {
+    return READ_PARSE_ERROR;
+  }
+
+  const char* headers = buf->data;
+  const char* headers_end = buf->data + header_end;
+  *should_close = 0;
+  const char* connection = find_header(headers, headers_end, "Connection");
+  if (connection && strncasecmp(connection, "close", 5) == 0) {
+    *should_close = 1;
+  }
+  if (strncmp(buf->data, "HTTP/1.0", 8) == 0 &&
+      !(connection && strncasecmp(connection, "keep-alive", 10) == 0)) {
+    *should_close = 1;
+  }
+
+  size_t content_length = 0;
+  const char* length_value = find_header(headers, headers_end, "Content-Length");
+  if (length_value) {
+    content_length = (size_t)strtoull(length_value, NULL, 10);
+  } else if (*status != 204 && *status != 304 && *status >= 200) {
+    // 没有 Content-Length：响应体持续到连接关闭
+    for (;;) {
+      if (buffer_reserve(buf, 16384) < 0) {
+        return READ_IO_ERROR;
+      }
+      ssize_t n = recv(fd, buf->data + buf->len, buf->cap - buf->len, 0);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        break;
+      }
+      buf->len += (size_t)n;
+    }
+    *bytes = buf->len;
+    buf->len = 0;
+    *should_close = 1;
+    return READ_OK;
+  }
+
+  size_t total = header_end + content_length;
+  while (buf->len < total) {
+    if (buffer_reserve(buf, total - buf->len) < 0) {
+      return READ_IO_ERROR;
+    }
+    ssize_t n = recv(fd, buf->data + buf->len, buf->cap - buf->len, 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return READ_IO_ERROR;
+    }
+    buf->len += (size_t)n;
+  }
+  *bytes = total;
+  buffer_consume(buf, total);
+  return READ_OK;
+}
+
+static void* worker_main(void* arg) {
+  worker_t* w = arg;
+  stats_t* stats = &w->stats;
+  buffer_t buf = {0};
+  int fd = -1;
+
+  while (atomic_load_explicit(&g_phase, memory_order_relaxed) < 2) {
+    if (fd < 0) {
+      fd = open_connection(w);
+      if (fd < 0) {
+        if (atomic_load_explicit(&g_phase, memory_order_relaxed) == 1) {
+          stats->counters.connect_errors++;
+        }
+        usleep(10000);
+        continue;
+      }
+      buf.len = 0;
+    }
+
+    int index = 0;
+    const request_spec_t* spec = pick_request(w, &index);
+    uint64_t start = now_micros();
+    int status = 0;
+    int should_close = 0;
+    size_t bytes = 0;
+    read_result_t result = READ_IO_ERROR;
+    if (send_all(fd, spec->raw, spec->raw_len) == 0) {
+      result = read_response(fd, &buf, &status, &should_close, &bytes);
+    }
+    uint64_t elapsed = now_micros() - start;
+
+    // 预热阶段的请求不计入统计
+    int measuring = atomic_load_explicit(&g_phase, memory_order_relaxed) == 1;
+    if (result != READ_OK) {
+      if (measuring) {
+        if (result == READ_PARSE_ERROR) {
+          stats->counters.parse_errors++;
+        } else {
+          stats->counters.io_errors++;
+        }
+      }
+      close(fd);
+      fd = -1;
+      if (measuring) {
+        stats->counters.reconnects++;
+      }
+      continue;
+    }
+    if (measuring) {
+      stats->counters.requests++;
+      stats->counters.status[status / 100]++;
+      stats->counters.bytes_out += spec->raw_len;
+      stats->counters.bytes_in += bytes;
+      histogram_record(&stats->latency, elapsed);
+      histogram_record(&stats->by_spec[index], elapsed);
+      stats->spec_counts[index]++;
+    }
+    if (should_close) {
+      close(fd);
+      fd = -1;
+      if (measuring) {
+        stats->counters.reconnects++;
+      }
+    }
+  }
+
+  if (fd >= 0) {
+    close(fd);
+  }
+  free(buf.data);
+  return NULL;
+}
+
+// ========== 输出 ==========
+
+static void print_latency_json(FILE* out, const histogram_t* h,
+                               const char* indent) {
+  double mean = h->total ? (double)h->sum / (double)h->total : 0.0;
+  fprintf(out,
+          "{\n"
+          "%s  \"min\": %llu,\n"
+          "%s  \"mean\": %.1f,\n"
+          "%s  \"p50\": %llu,\n"
+          "%s  \"p90\": %llu,\n"
+          "%s  \"p99\": %llu,\n"
+          "%s  \"p999\": %llu,\n"
+          "%s  \"max\": %llu\n"
+          "%s}",
+          indent, (unsigned long long)h->min, indent, mean, indent,
+          (unsigned long long)histogram_percentile(h, 0.5), indent,
+          (unsigned long long)histogram_percentile(h, 0.9), indent,
+          (unsigned long long)histogram_percentile(h, 0.99), indent,
+          (unsigned long long)histogram_percentile(h, 0.999), indent,
+          (unsigned long long)h->max, indent);
+}
+
+static void print_json_string(FILE* out, const char* s) {
+  fputc('"', out);
+  for (; *s; s++) {
+    unsigned char c = (unsigned char)*s;
+    if (c == '"' || c == '\\') {
+      fputc('\\', out);
+      fputc(c, out);
+    } else if (c < 0x20) {
+      fprintf(out, "\\u%04x", c);
+    } else {
+      fputc(c, out);
+    }
+  }
+  fputc('"', out);
+}
+
+static void print_report(FILE* out, const char* host, int port, int connections,
+                         double seconds, const request_mix_t* mix,
+                         const stats_t* total) {
+  const counters_t* c = &total->counters;
+  uint64_t errors = c->connect_errors + c->io_errors + c->parse_errors;
+  uint64_t attempts = c->requests + c->io_errors + c->parse_errors;
+  uint64_t non_2xx = c->requests - c->status[2] - c->status[3];
+  fprintf(out, "{\n");
+  fprintf(out, "  \"target\": ");
+  print_json_string(out, host);
+  fprintf(out, ",\n  \"port\": %d,\n", port);
+  fprintf(out, "  \"connections\": %d,\n", connections);
+  fprintf(out, "  \"duration_seconds\": %.3f,\n", seconds);
+  fprintf(out, "  \"requests\": %llu,\n", (unsigned long long)c->requests);
+  fprintf(out, "  \"throughput_rps\": %.1f,\n",
+          seconds > 0 ? (double)c->requests / seconds : 0.0);
+  fprintf(out, "  \"bytes_in\": %llu,\n", (unsigned long long)c->bytes_in);
+  fprintf(out, "  \"bytes_out\": %llu,\n", (unsigned long long)c->bytes_out);
+  fprintf(out, "  \"latency_us\": ");
+  print_latency_json(out, &total->latency, "  ");
+  fprintf(out, ",\n  \"status\": {");
+  int first = 1;
+  for (int i = 1; i <= 5; i++) {
+    if (c->status[i] > 0) {
+      fprintf(out, "%s\"%dxx\": %llu", first ? "" : ", ", i,
+              (unsigned long long)c->status[i]);
+      first = 0;
+    }
+  }
+  fprintf(out, "},\n");
+  fprintf(out,
+          "  \"errors\": {\"connect\": %llu, \"io\": %llu, \"parse\": %llu, "
+          "\"reconnects\": %llu},\n",
+          (unsigned long long)c->connect_errors,
+          (unsigned long long)c->io_errors, (unsigned long long)c->parse_errors,
+          (unsigned long long)c->reconnects);
+  fprintf(out, "  \"error_rate\": %.6f,\n",
+          attempts ? (double)(c->io_errors + c->parse_errors) / (double)attempts
+                   : (errors ? 1.0 : 0.0));
+  fprintf(out, "  \"non_2xx_3xx_rate\": %.6f,\n",
+          c->requests ? (double)non_2xx / (double)c->requests : 0.0);
+  fprintf(out, "  \"routes\": [\n");
+  for (int i = 0; i < mix->count; i++) {
+    fprintf(out, "    {\n      \"request\": ");
+    print_json_string(out, mix->items[i].name);
+    fprintf(out, ",\n      \"weight\": %d,\n", mix->items[i].weight);
+    fprintf(out, "      \"requests\": %llu,\n",
+            (unsigned long long)total->spec_counts[i]);
+    fprintf(out, "      \"latency_us\": ");
+    print_latency_json(out, &total->by_spec[i], "      ");
+    fprintf(out, "\n    }%s\n", i + 1 < mix->count ? "," : "");
+  }
+  fprintf(out, "  ]\n}\n");
+}
+
+// ========== 入口 ==========
+
+static void usage(const char* program) {
+  fprintf(stderr,
+          "usage: %s [-H host] [-p port] [-c connections] [-d seconds]\n"
+          "          [-w warmup_seconds] [-m mix_file] [-o output.json]\n",
+          program);
+}
+
+static int stats_init(stats_t* stats, int spec_count) {
+  memset(stats, 0, sizeof(*stats));
+  stats->by_spec = calloc((size_t)spec_count, sizeof(histogram_t));
+  stats->spec_counts = calloc((size_t)spec_count, sizeof(uint64_t));
+  return stats->by_spec && stats->spec_counts ? 0 : -1;
+}
+
+int main(int argc, char** argv) {
+  const char* host = "127.0.0.1";
+  int port = 8080;
+  int connections = 16;
+  double duration = 10.0;
+  double warmup = 1.0;
+  const char* mix_file = NULL;
+  const char* output_file = NULL;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "H:p:c:d:w:m:o:h")) != -1) {
+    switch (opt) {
+      case 'H': host = optarg; break;
+      case 'p': port = atoi(optarg); break;
+      case 'c': connections = atoi(optarg); break;
+      case 'd': duration = atof(optarg); break;
+      case 'w': warmup = atof(optarg); break;
+      case 'm': mix_file = optarg; break;
+      case 'o': output_file = optarg; break;
+      default: usage(argv[0]); return 2;
+    }
+  }
+  if (port <= 0 || port > 65535 || connections <= 0 || duration <= 0 ||
+      warmup < 0) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  struct addrinfo hints = {0};
+  struct addrinfo* resolved = NULL;
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  char port_str[16];
+  snprintf(port_str, sizeof(port_str), "%d", port);
+  int rc = getaddrinfo(host, port_str, &hints, &resolved);
+  if (rc != 0) {
+    fprintf(stderr, "loadgen: cannot resolve %s: %s\n", host, gai_strerror(rc));
+    return 1;
+  }
+
+  request_mix_t mix = {0};
+  if ((mix_file ? mix_load_file(&mix, host, port, mix_file)
+                : mix_load_default(&mix, host, port)) < 0) {
+    freeaddrinfo(resolved);
+    return 1;
+  }
+
+  worker_t* workers = calloc((size_t)connections, sizeof(worker_t));
+  pthread_t* threads = calloc((size_t)connections, sizeof(pthread_t));
+  if (!workers || !threads) {
+    fprintf(stderr, "loadgen: out of memory\n");
+    return 1;
+  }
+  uint64_t seed = now_micros() | 1;
+  for (int i = 0; i < connections; i++) {
+    worker_t* w = &workers[i];
+    w->id = i;
+    w->mix = &mix;
+    memcpy(&w->addr, resolved->ai_addr, resolved->ai_addrlen);
+    w->addr_len = (socklen_t)resolved->ai_addrlen;
+    w->rng = seed + (uint64_t)i * 0x9E3779B97F4A7C15ULL;
+    if (stats_init(&w->stats, mix.count) < 0) {
+      fprintf(stderr, "loadgen: out of memory\n");
+      return 1;
+    }
+  }
+  freeaddrinfo(resolved);
+
+  atomic_store(&g_phase, warmup > 0 ? 0 : 1);
+  int started = 0;
+  for (; started < connections; started++) {
+    if (pthread_create(&threads[started], NULL, worker_main,
+                       &workers[started]) != 0) {
+      fprintf(stderr, "loadgen: cannot start worker %d\n", started);
+      break;
+    }
+  }
+
+  if (warmup > 0) {
+    usleep((useconds_t)(warmup * 1e6));
+    atomic_store(&g_phase, 1);
+  }
+  uint64_t measure_start = now_micros();
+  usleep((useconds_t)(duration * 1e6));
+  atomic_store(&g_phase, 2);
+  double elapsed = (double)(now_micros() - measure_start) / 1e6;
+
+  stats_t total;
+  if (stats_init(&total, mix.count) < 0) {
+    fprintf(stderr, "loadgen: out of memory\n");
+    return 1;
+  }
+  for (int i = 0; i < started; i++) {
+    pthread_join(threads[i], NULL);
+    const stats_t* s = &workers[i].stats;
+    histogram_merge(&total.latency, &s->latency);
+    for (int j = 0; j < mix.count; j++) {
+      histogram_merge(&total.by_spec[j], &s->by_spec[j]);
+      total.spec_counts[j] += s->spec_counts[j];
+    }
+    const counters_t* c = &s->counters;
+    total.counters.requests += c->requests;
+    for (int k = 0; k < 6; k++) {
+      total.counters.status[k] += c->status[k];
+    }
+    total.counters.connect_errors += c->connect_errors;
+    total.counters.io_errors += c->io_errors;
+    total.counters.parse_errors += c->parse_errors;
+    total.counters.reconnects += c->reconnects;
+    total.counters.bytes_in += c->bytes_in;
+    total.counters.bytes_out += c->bytes_out;
+  }
+
+  FILE* out = stdout;
+  if (output_file) {
+    out = fopen(output_file, "w");
+    if (!out) {
+      fprintf(stderr, "loadgen: cannot open %s: %s\n", output_file,
+              strerror(errno));
+      return 1;
+    }
+  }
+  print_report(out, host, port, started, elapsed, &mix, &total);
+  if (out != stdout) {
+    fclose(out);
+  }
+
+  return total.counters.requests > 0 ? 0 : 1;
+}
@@ -0,0 +1,24 @@
+#!/usr/bin/env bash
+# 编译 loadgen 并对本机服务器压测，结果写入 loadgen/results/<名称>.json
+#
+# 用法：
+#   loadgen/run.sh <名称> [loadgen 参数...]
+#
+# 示例：
+#   loadgen/run.sh embedded -p 8080 -c 32 -d 30
+#   loadgen/run.sh async -p 8080 -c 32 -d 30 -m loadgen/autumn-demo.mix
+set -euo pipefail
+
+if [ $# -lt 1 ]; then
+  echo "usage: $0 <name> [loadgen options...]" >&2
+  exit 2
+fi
+
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+NAME="$1"
+shift
+
+gcc -O2 -pthread -o "$ROOT/loadgen/loadgen" "$ROOT/loadgen/loadgen.c"
+mkdir -p "$ROOT/loadgen/results"
+"$ROOT/loadgen/loadgen" "$@" -o "$ROOT/loadgen/results/$NAME.json"
+cat "$ROOT/loadgen/results/$NAME.json"
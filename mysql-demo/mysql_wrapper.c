@@ -9,6 +9,12 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <ctype.h>
+#include <strings.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 // MoonBit 运行时头文件
 #include <moonbit.h>
@@ -17,6 +23,9 @@
 #define MAX_HANDLES 100
 static MYSQL* mysql_handles[MAX_HANDLES] = {NULL};
 
+// 每个连接最后一条语句影响的行数（预编译语句的行数只能从 MYSQL_STMT 取得，不能用 mysql_affected_rows）
+static long long mysql_last_affected[MAX_HANDLES] = {0};
+
 // 获取 MySQL 连接句柄
 static MYSQL* get_mysql(int handle) {
     if (handle >= 0 && handle < MAX_HANDLES) {
@@ -33,6 +42,7 @@ static int store_mysql(MYSQL* mysql) {
     for (int i = 0; i < MAX_HANDLES; i++) {
         if (mysql_handles[i] == NULL) {
             mysql_handles[i] = mysql;
+            mysql_last_affected[i] = 0;
             return i;
         }
     }
@@ -112,6 +122,763 @@ static const char* get_c_string(moonbit_string_t str) {
     return get_c_string_to_buffer(str, static_buffer, sizeof(static_buffer));
 }
 
+// ========== 查询结果行 ==========
+
+// 单次查询最多返回的行数
+#define MAX_ROWS 1000
+
+// 将一列追加到行缓冲区（格式：column1=value1\tcolumn2=value2\t...），返回新的写入位置
+static int append_column(char* row_buffer, int pos, int size, int index,
+                         const char* name, const char* value, unsigned long value_len) {
+    if (index > 0 && pos < size - 1) {
+        row_buffer[pos++] = '\t';
+    }
+    if (name != NULL) {
+        int name_len = strlen(name);
+        if (pos + name_len + 1 < size) {
+            memcpy(row_buffer + pos, name, name_len);
+            pos += name_len;
+            row_buffer[pos++] = '=';
+        }
+    }
+    if (value != NULL && pos + (long)value_len < size) {
+        memcpy(row_buffer + pos, value, value_len);
+        pos += value_len;
+    }
+    row_buffer[pos] = '\0';
+    return pos;
+}
+
+// 将行缓冲区转换为 MoonBit String
+static moonbit_string_t make_row_string(const char* row_buffer, int len) {
+    moonbit_string_t row_str = moonbit_make_string_raw(len + 1);
+    for (int i = 0; i < len; i++) {
+        row_str[i] = (uint16_t)(unsigned char)row_buffer[i];
+    }
+    row_str[len] = 0;
+    return row_str;
+}
+
+// ========== 预编译语句缓存 ==========
+//
+// 每个连接一个按 SQL 文本索引的 LRU 缓存。命中时直接重新执行已预编译的语句
+// （二进制协议），省去每次 COM_STMT_PREPARE 的往返和服务端解析；
+// 语句用完后只释放结果集（mysql_stmt_free_result），不关闭。
+// 无法预编译的语句（部分管理语句）退回文本协议，不进入缓存。
+
+#define STMT_CACHE_CAPACITY 32
+
+// MYSQL_BIND 的标志类型（MySQL 5.7 为 my_bool，8.0 为 bool）
+typedef __typeof__(*((MYSQL_BIND*)0)->is_null) mysql_flag_t;
+
+typedef struct {
+    char* sql;            // SQL 文本（malloc 分配，NULL 表示空槽位）
+    uint32_t hash;        // SQL 文本的哈希值
+    MYSQL_STMT* stmt;     // 预编译语句
+    uint64_t last_used;   // 最后使用时间（LRU 时钟）
+} stmt_cache_entry;
+
+typedef struct {
+    stmt_cache_entry entries[STMT_CACHE_CAPACITY];
+    int size;             // 已使用的槽位数
+    uint64_t clock;       // LRU 时钟
+    int hits;             // 命中次数
+    int misses;           // 未命中次数
+    int evictions;        // 淘汰次数
+} stmt_cache;
+
+static stmt_cache stmt_caches[MAX_HANDLES];
+
+// FNV-1a 哈希
+static uint32_t sql_hash(const char* sql) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)sql; *p; p++) {
+        hash = (hash ^ *p) * 16777619u;
+    }
+    return hash;
+}
+
+// 获取预编译语句：命中缓存时复用，否则预编译并放入缓存（淘汰最久未使用的语句）
+//
+// 返回 NULL 表示语句无法预编译，调用方应使用文本协议
+static MYSQL_STMT* stmt_cache_acquire(int handle, MYSQL* mysql, const char* sql) {
+    stmt_cache* cache = &stmt_caches[handle];
+    uint32_t hash = sql_hash(sql);
+
+    for (int i = 0; i < STMT_CACHE_CAPACITY; i++) {
+        stmt_cache_entry* entry = &cache->entries[i];
+        if (entry->sql != NULL && entry->hash == hash && strcmp(entry->sql, sql) == 0) {
+            cache->hits++;
+            entry->last_used = ++cache->clock;
+            return entry->stmt;
+        }
+    }
+
+    cache->misses++;
+    MYSQL_STMT* stmt = mysql_stmt_init(mysql);
+    if (stmt == NULL) {
+        return NULL;
+    }
+    if (mysql_stmt_prepare(stmt, sql, strlen(sql)) != 0) {
+        mysql_stmt_close(stmt);
+        return NULL;
+    }
+    // 让 mysql_stmt_store_result 计算每列的最大长度，用于分配结果缓冲区
+    mysql_flag_t update_max_length = 1;
+    mysql_stmt_attr_set(stmt, STMT_ATTR_UPDATE_MAX_LENGTH, &update_max_length);
+
+    char* key = strdup(sql);
+    if (key == NULL) {
+        mysql_stmt_close(stmt);
+        return NULL;
+    }
+
+    // 选择空槽位，缓存已满时淘汰最久未使用的语句
+    stmt_cache_entry* slot = NULL;
+    for (int i = 0; i < STMT_CACHE_CAPACITY; i++) {
+        stmt_cache_entry* entry = &cache->entries[i];
+        if (entry->sql == NULL) {
+            slot = entry;
+            break;
+        }
+        if (slot == NULL || entry->last_used < slot->last_used) {
+            slot = entry;
+        }
+    }
+    if (slot->sql != NULL) {
+        mysql_stmt_close(slot->stmt);
+        free(slot->sql);
+        cache->size--;
+        cache->evictions++;
+    }
+    slot->sql = key;
+    slot->hash = hash;
+    slot->stmt = stmt;
+    slot->last_used = ++cache->clock;
+    cache->size++;
+    return stmt;
+}
+
+// 清空连接的语句缓存（关闭连接前调用）
+static void stmt_cache_clear(int handle) {
+    stmt_cache* cache = &stmt_caches[handle];
+    for (int i = 0; i < STMT_CACHE_CAPACITY; i++) {
+        stmt_cache_entry* entry = &cache->entries[i];
+        if (entry->sql != NULL) {
+            mysql_stmt_close(entry->stmt);
+            free(entry->sql);
+        }
+    }
+    memset(cache, 0, sizeof(*cache));
+}
+
+// ========== 列式结果批次 ==========
+//
+// 游标每次取出一批行，以列式二进制格式返回给 MoonBit（ResultCursor.mbt 负责解码）：
+//
+//   byte     状态：0 可能还有后续批次，1 结果集已读完，2 出错
+//   u32      列数（小端）
+//   u32      行数（小端）
+//   每列：
+//     uvarint  列名字节数，随后是列名（UTF-8）
+//     byte     类型：0 全为 NULL，1 整数，2 浮点数，3 文本，4 二进制
+//     bytes    NULL 位图，(行数 + 7) / 8 字节，第 i 位为 1 表示第 i 行为 NULL
+//     每行一个值（NULL 行同样占位）：整数为 zigzag varint，浮点数为 8 字节小端，
+//     文本和二进制为 uvarint 字节数 + 字节
+//
+// 一批数据先按行暂存为单元格，批次结束后再确定每列的类型并转为列式，
+// 因此内存占用只与批次大小有关，与结果集的总行数无关。
+
+#define CELL_NULL 0
+#define CELL_INT 1
+#define CELL_REAL 2
+#define CELL_TEXT 3
+#define CELL_BLOB 4
+
+#define DEFAULT_BATCH_ROWS 256
+#define MAX_BATCH_ROWS 65536
+
+// 可增长的字节缓冲区
+typedef struct {
+    uint8_t* data;
+    size_t len;
+    size_t cap;
+    int failed;           // 分配失败后不再写入
+} byte_buf;
+
+static int buf_reserve(byte_buf* buf, size_t extra) {
+    if (buf->failed) {
+        return 0;
+    }
+    if (buf->len + extra <= buf->cap) {
+        return 1;
+    }
+    size_t cap = buf->cap == 0 ? 1024 : buf->cap;
+    while (cap < buf->len + extra) {
+        cap *= 2;
+    }
+    uint8_t* data = (uint8_t*)realloc(buf->data, cap);
+    if (data == NULL) {
+        buf->failed = 1;
+        return 0;
+    }
+    buf->data = data;
+    buf->cap = cap;
+    return 1;
+}
+
+static void buf_put(byte_buf* buf, const void* data, size_t len) {
+    if (len > 0 && buf_reserve(buf, len)) {
+        memcpy(buf->data + buf->len, data, len);
+        buf->len += len;
+    }
+}
+
+static void buf_byte(byte_buf* buf, uint8_t value) {
+    buf_put(buf, &value, 1);
+}
+
+static void buf_u32(byte_buf* buf, uint32_t value) {
+    uint8_t bytes[4] = {
+        (uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)
+    };
+    buf_put(buf, bytes, 4);
+}
+
+static void buf_uvarint(byte_buf* buf, uint64_t value) {
+    uint8_t bytes[10];
+    int n = 0;
+    while (value >= 0x80) {
+        bytes[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    bytes[n++] = (uint8_t)value;
+    buf_put(buf, bytes, n);
+}
+
+static void buf_free(byte_buf* buf) {
+    free(buf->data);
+    memset(buf, 0, sizeof(*buf));
+}
+
+// 一批结果的构建器
+typedef struct {
+    int columns;
+    int rows;
+    byte_buf cells;       // 按行暂存的单元格：1 字节类型 + 值（数值 8 字节，文本/二进制 u32 长度 + 字节）
+    size_t* offsets;      // 每个单元格在 cells 中的偏移，共 rows * columns 个
+    size_t offsets_cap;
+    int* type_masks;      // 每列出现过的非 NULL 单元格类型（1 << CELL_*）
+    int failed;
+} batch_builder;
+
+static int batch_init(batch_builder* batch, int columns) {
+    memset(batch, 0, sizeof(*batch));
+    batch->columns = columns;
+    batch->type_masks = (int*)calloc(columns > 0 ? columns : 1, sizeof(int));
+    return batch->type_masks != NULL;
+}
+
+static void batch_free(batch_builder* batch) {
+    buf_free(&batch->cells);
+    free(batch->offsets);
+    free(batch->type_masks);
+    memset(batch, 0, sizeof(*batch));
+}
+
+// 记录下一个单元格的起始位置
+static int batch_begin_cell(batch_builder* batch) {
+    size_t index = (size_t)batch->rows * batch->columns;
+    size_t needed = index + batch->columns;
+    if (needed > batch->offsets_cap) {
+        size_t cap = batch->offsets_cap == 0 ? 256 : batch->offsets_cap;
+        while (cap < needed) {
+            cap *= 2;
+        }
+        size_t* offsets = (size_t*)realloc(batch->offsets, cap * sizeof(size_t));
+        if (offsets == NULL) {
+            batch->failed = 1;
+            return 0;
+        }
+        batch->offsets = offsets;
+        batch->offsets_cap = cap;
+    }
+    return 1;
+}
+
+static void batch_cell(batch_builder* batch, int column, int type, const void* data, size_t len) {
+    if (batch->failed || !batch_begin_cell(batch)) {
+        return;
+    }
+    batch->offsets[(size_t)batch->rows * batch->columns + column] = batch->cells.len;
+    buf_byte(&batch->cells, (uint8_t)type);
+    if (type == CELL_TEXT || type == CELL_BLOB) {
+        uint32_t size = (uint32_t)len;
+        buf_put(&batch->cells, &size, sizeof(size));
+        buf_put(&batch->cells, data, len);
+    } else if (type != CELL_NULL) {
+        buf_put(&batch->cells, data, 8);
+    }
+    if (type != CELL_NULL) {
+        batch->type_masks[column] |= 1 << type;
+    }
+    if (batch->cells.failed) {
+        batch->failed = 1;
+    }
+}
+
+static void batch_null(batch_builder* batch, int column) {
+    batch_cell(batch, column, CELL_NULL, NULL, 0);
+}
+
+static void batch_int(batch_builder* batch, int column, int64_t value) {
+    batch_cell(batch, column, CELL_INT, &value, 8);
+}
+
+static void batch_real(batch_builder* batch, int column, double value) {
+    batch_cell(batch, column, CELL_REAL, &value, 8);
+}
+
+// 写入文本或二进制单元格
+static void batch_bytes(batch_builder* batch, int column, int type, const void* data, size_t len) {
+    batch_cell(batch, column, type, data, len);
+}
+
+// 一行的所有列写完后调用
+static void batch_end_row(batch_builder* batch) {
+    if (!batch->failed) {
+        batch->rows++;
+    }
+}
+
+// 一列的输出类型：只有整数时为整数，只有数值时为浮点数，只有二进制时为二进制，混合类型统一为文本
+static int batch_column_type(int mask) {
+    if (mask == 0) {
+        return CELL_NULL;
+    }
+    if (mask == (1 << CELL_INT)) {
+        return CELL_INT;
+    }
+    if ((mask & ~((1 << CELL_INT) | (1 << CELL_REAL))) == 0) {
+        return CELL_REAL;
+    }
+    if (mask == (1 << CELL_BLOB)) {
+        return CELL_BLOB;
+    }
+    return CELL_TEXT;
+}
+
+// 写入一个单元格的值（按列的输出类型转换）
+static void batch_encode_value(byte_buf* out, const uint8_t* cell, int column_type) {
+    int type = cell[0];
+    int64_t int_value = 0;
+    double real_value = 0.0;
+    if (type == CELL_INT) {
+        memcpy(&int_value, cell + 1, 8);
+        real_value = (double)int_value;
+    } else if (type == CELL_REAL) {
+        memcpy(&real_value, cell + 1, 8);
+    }
+
+    switch (column_type) {
+        case CELL_INT:
+            buf_uvarint(out, ((uint64_t)int_value << 1) ^ (uint64_t)(int_value >> 63));
+            break;
+        case CELL_REAL: {
+            uint64_t bits;
+            memcpy(&bits, &real_value, 8);
+            for (int shift = 0; shift < 64; shift += 8) {
+                buf_byte(out, (uint8_t)(bits >> shift));
+            }
+            break;
+        }
+        default: {
+            char number[32];
+            const uint8_t* data = NULL;
+            uint32_t len = 0;
+            if (type == CELL_INT) {
+                len = (uint32_t)snprintf(number, sizeof(number), "%lld", (long long)int_value);
+                data = (const uint8_t*)number;
+            } else if (type == CELL_REAL) {
+                len = (uint32_t)snprintf(number, sizeof(number), "%.17g", real_value);
+                data = (const uint8_t*)number;
+            } else if (type == CELL_TEXT || type == CELL_BLOB) {
+                memcpy(&len, cell + 1, sizeof(len));
+                data = cell + 1 + sizeof(len);
+            }
+            buf_uvarint(out, len);
+            buf_put(out, data, len);
+            break;
+        }
+    }
+}
+
+// 构造只有状态、没有列和行的批次（出错或游标无效时使用）
+static moonbit_bytes_t batch_empty(int status) {
+    moonbit_bytes_t result = moonbit_make_bytes(9, 0);
+    result[0] = (uint8_t)status;
+    return result;
+}
+
+// 把暂存的单元格编码为列式批次，写入 out（C 堆内存，可以在工作线程中调用），失败时返回 0
+static int batch_encode(batch_builder* batch, int status, const char** names, byte_buf* out) {
+    if (batch->failed) {
+        return 0;
+    }
+    buf_byte(out, (uint8_t)status);
+    buf_u32(out, (uint32_t)batch->columns);
+    buf_u32(out, (uint32_t)batch->rows);
+    int bitmap_len = (batch->rows + 7) / 8;
+    for (int c = 0; c < batch->columns; c++) {
+        const char* name = names[c] != NULL ? names[c] : "";
+        size_t name_len = strlen(name);
+        buf_uvarint(out, name_len);
+        buf_put(out, name, name_len);
+
+        int column_type = batch_column_type(batch->type_masks[c]);
+        buf_byte(out, (uint8_t)column_type);
+        if (!buf_reserve(out, bitmap_len)) {
+            break;
+        }
+        uint8_t* bitmap = out->data + out->len;
+        memset(bitmap, 0, bitmap_len);
+        out->len += bitmap_len;
+        for (int r = 0; r < batch->rows; r++) {
+            const uint8_t* cell = batch->cells.data + batch->offsets[(size_t)r * batch->columns + c];
+            if (cell[0] == CELL_NULL) {
+                bitmap[r / 8] |= (uint8_t)(1 << (r % 8));
+            }
+        }
+        if (column_type == CELL_NULL) {
+            continue;
+        }
+        for (int r = 0; r < batch->rows; r++) {
+            const uint8_t* cell = batch->cells.data + batch->offsets[(size_t)r * batch->columns + c];
+            batch_encode_value(out, cell, column_type);
+        }
+    }
+    return !out->failed;
+}
+
+// 把编码好的批次复制为 MoonBit Bytes 并释放缓冲区（只能在调用线程中使用）
+static moonbit_bytes_t buf_take_bytes(byte_buf* buf) {
+    moonbit_bytes_t result = moonbit_make_bytes((int32_t)buf->len, 0);
+    if (buf->len > 0) {
+        memcpy(result, buf->data, buf->len);
+    }
+    buf_free(buf);
+    return result;
+}
+
+// 把暂存的单元格编码为 MoonBit Bytes，出错时返回状态为出错的空批次
+static moonbit_bytes_t batch_finish(batch_builder* batch, int status, const char** names) {
+    byte_buf out = {0};
+    if (!batch_encode(batch, status, names, &out)) {
+        buf_free(&out);
+        return batch_empty(2);
+    }
+    return buf_take_bytes(&out);
+}
+
+// 规范化每批的最大行数
+static int batch_rows_limit(int max_rows) {
+    if (max_rows <= 0) {
+        return DEFAULT_BATCH_ROWS;
+    }
+    return max_rows > MAX_BATCH_ROWS ? MAX_BATCH_ROWS : max_rows;
+}
+
+// ========== 类型化参数 ==========
+//
+// MoonBit 侧（SqlParam.mbt 的 encode_params）把参数打包为一段字节：
+//
+//   u32      参数个数（小端）
+//   每个参数：1 字节类型 + 值
+//     0 NULL
+//     1 整数：8 字节小端 Int64
+//     2 浮点数：8 字节小端 Double
+//     3 布尔：1 字节
+//     4 文本：u32 字节数 + UTF-8
+//     5 二进制：u32 字节数 + 字节
+//
+// 批量执行时为 u32 组数，随后依次是每组参数（格式同上）。
+
+#define PARAM_NULL 0
+#define PARAM_INT 1
+#define PARAM_REAL 2
+#define PARAM_BOOL 3
+#define PARAM_TEXT 4
+#define PARAM_BLOB 5
+
+typedef struct {
+    int type;
+    int64_t int_value;    // 整数和布尔值
+    double real_value;
+    const uint8_t* data;  // 文本和二进制（指向参数缓冲区，调用期间有效）
+    uint32_t len;
+} param_value;
+
+typedef struct {
+    const uint8_t* pos;
+    const uint8_t* end;
+} param_reader;
+
+static uint64_t read_le(const uint8_t* data, int size) {
+    uint64_t value = 0;
+    for (int i = 0; i < size; i++) {
+        value |= (uint64_t)data[i] << (8 * i);
+    }
+    return value;
+}
+
+static void param_init_range(param_reader* reader, const uint8_t* data, size_t len) {
+    reader->pos = data;
+    reader->end = data + len;
+}
+
+static void param_init(param_reader* reader, moonbit_bytes_t params) {
+    param_init_range(reader, params, params == NULL ? 0 : Moonbit_array_length(params));
+}
+
+// 读取一个 u32 个数（参数个数或批量执行的组数），格式错误时返回 -1
+static int param_count(param_reader* reader) {
+    if (reader->end - reader->pos < 4) {
+        return -1;
+    }
+    uint32_t count = (uint32_t)read_le(reader->pos, 4);
+    reader->pos += 4;
+    // 每个参数至少占 1 字节
+    return count <= (size_t)(reader->end - reader->pos) ? (int)count : -1;
+}
+
+// 开始读取参数，返回参数个数（空字节表示没有参数），格式错误时返回 -1
+static int param_begin(param_reader* reader, moonbit_bytes_t params) {
+    param_init(reader, params);
+    return reader->pos == reader->end ? 0 : param_count(reader);
+}
+
+// 读取下一个参数，格式错误时返回 0
+static int param_next(param_reader* reader, param_value* value) {
+    if (reader->pos >= reader->end) {
+        return 0;
+    }
+    memset(value, 0, sizeof(*value));
+    value->type = *reader->pos++;
+    size_t left = (size_t)(reader->end - reader->pos);
+    switch (value->type) {
+        case PARAM_NULL:
+            return 1;
+        case PARAM_INT:
+        case PARAM_REAL: {
+            if (left < 8) {
+                return 0;
+            }
+            uint64_t bits = read_le(reader->pos, 8);
+            reader->pos += 8;
+            if (value->type == PARAM_INT) {
+                value->int_value = (int64_t)bits;
+            } else {
+                memcpy(&value->real_value, &bits, 8);
+            }
+            return 1;
+        }
+        case PARAM_BOOL:
+            if (left < 1) {
+                return 0;
+            }
+            value->int_value = *reader->pos++ != 0;
+            return 1;
+        case PARAM_TEXT:
+        case PARAM_BLOB:
+            if (left < 4) {
+                return 0;
+            }
+            value->len = (uint32_t)read_le(reader->pos, 4);
+            reader->pos += 4;
+            if (value->len > left - 4) {
+                return 0;
+            }
+            value->data = reader->pos;
+            reader->pos += value->len;
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+
+// 解码后的参数绑定（文本和二进制的缓冲区指向参数字节，调用期间有效）
+typedef struct {
+    int count;
+    MYSQL_BIND* binds;
+    long long* ints;
+    double* reals;
+    unsigned long* lengths;
+} mysql_params;
+
+static const mysql_params no_params = {0, NULL, NULL, NULL, NULL};
+
+static void mysql_params_free(mysql_params* params) {
+    free(params->binds);
+    free(params->ints);
+    free(params->reals);
+    free(params->lengths);
+    *params = no_params;
+}
+
+static int mysql_params_alloc(mysql_params* out, int count) {
+    *out = no_params;
+    if (count == 0) {
+        return 1;
+    }
+    out->count = count;
+    out->binds = calloc(count, sizeof(MYSQL_BIND));
+    out->ints = calloc(count, sizeof(long long));
+    out->reals = calloc(count, sizeof(double));
+    out->lengths = calloc(count, sizeof(unsigned long));
+    if (out->binds == NULL || out->ints == NULL || out->reals == NULL || out->lengths == NULL) {
+        mysql_params_free(out);
+        return 0;
+    }
+    return 1;
+}
+
+// 从读取器读取 count 个参数，填入绑定数组的 [offset, offset + count)，格式错误时返回 0
+static int mysql_params_read(mysql_params* out, param_reader* reader, int offset, int count) {
+    for (int i = offset; i < offset + count; i++) {
+        param_value value;
+        if (!param_next(reader, &value)) {
+            return 0;
+        }
+        MYSQL_BIND* bind = &out->binds[i];
+        switch (value.type) {
+            case PARAM_INT:
+            case PARAM_BOOL:
+                out->ints[i] = (long long)value.int_value;
+                bind->buffer_type = MYSQL_TYPE_LONGLONG;
+                bind->buffer = &out->ints[i];
+                break;
+            case PARAM_REAL:
+                out->reals[i] = value.real_value;
+                bind->buffer_type = MYSQL_TYPE_DOUBLE;
+                bind->buffer = &out->reals[i];
+                break;
+            case PARAM_TEXT:
+            case PARAM_BLOB:
+                out->lengths[i] = value.len;
+                bind->buffer_type = value.type == PARAM_TEXT ? MYSQL_TYPE_STRING : MYSQL_TYPE_BLOB;
+                bind->buffer = (void*)value.data;
+                bind->buffer_length = value.len;
+                bind->length = &out->lengths[i];
+                break;
+            default:
+                bind->buffer_type = MYSQL_TYPE_NULL;
+                break;
+        }
+    }
+    return 1;
+}
+
+// 把打包的参数转换为 MYSQL_BIND 数组，格式错误或内存不足时返回 0
+static int mysql_params_decode(mysql_params* out, moonbit_bytes_t params) {
+    param_reader reader;
+    int count = param_begin(&reader, params);
+    if (count < 0 || !mysql_params_alloc(out, count)) {
+        return 0;
+    }
+    if (!mysql_params_read(out, &reader, 0, count)) {
+        mysql_params_free(out);
+        return 0;
+    }
+    return 1;
+}
+
+// 使用缓存的预编译语句执行 SQL，结果行写入 row_strings（最多 MAX_ROWS 行，为 NULL 时丢弃结果）
+//
+// 返回：1 成功，0 语句无法预编译（应使用文本协议），-1 执行失败（包括参数个数与占位符不一致）
+static int stmt_cache_execute(int handle, MYSQL* mysql, const char* sql, const mysql_params* params,
+                              moonbit_string_t* row_strings, int* row_count) {
+    MYSQL_STMT* stmt = stmt_cache_acquire(handle, mysql, sql);
+    if (stmt == NULL) {
+        // 文本协议无法携带参数
+        return params->count > 0 ? -1 : 0;
+    }
+    if ((int)mysql_stmt_param_count(stmt) != params->count) {
+        return -1;
+    }
+    if (params->count > 0 && mysql_stmt_bind_param(stmt, params->binds)) {
+        return -1;
+    }
+
+    MYSQL_RES* meta = mysql_stmt_result_metadata(stmt);
+    if (mysql_stmt_execute(stmt) != 0) {
+        if (meta != NULL) {
+            mysql_free_result(meta);
+        }
+        return -1;
+    }
+    if (meta == NULL) {
+        // 没有结果集的语句（INSERT / UPDATE / DDL 等）
+        mysql_last_affected[handle] = (long long)mysql_stmt_affected_rows(stmt);
+        return 1;
+    }
+    mysql_last_affected[handle] = 0;
+    if (row_strings == NULL) {
+        mysql_free_result(meta);
+        mysql_stmt_free_result(stmt);
+        return 1;
+    }
+    if (mysql_stmt_store_result(stmt) != 0) {
+        mysql_free_result(meta);
+        mysql_stmt_free_result(stmt);
+        return -1;
+    }
+
+    // 每列按最大长度分配缓冲区，以字符串形式取回
+    int num_fields = mysql_num_fields(meta);
+    MYSQL_FIELD* fields = mysql_fetch_fields(meta);
+    MYSQL_BIND* binds = calloc(num_fields, sizeof(MYSQL_BIND));
+    unsigned long* lengths = calloc(num_fields, sizeof(unsigned long));
+    mysql_flag_t* nulls = calloc(num_fields, sizeof(mysql_flag_t));
+    int ok = binds != NULL && lengths != NULL && nulls != NULL;
+    for (int i = 0; ok && i < num_fields; i++) {
+        unsigned long size = fields[i].max_length < 64 ? 64 : fields[i].max_length;
+        binds[i].buffer_type = MYSQL_TYPE_STRING;
+        binds[i].buffer = malloc(size + 1);
+        binds[i].buffer_length = size + 1;
+        binds[i].length = &lengths[i];
+        binds[i].is_null = &nulls[i];
+        ok = binds[i].buffer != NULL;
+    }
+    if (ok && mysql_stmt_bind_result(stmt, binds) == 0) {
+        while (*row_count < MAX_ROWS) {
+            int rc = mysql_stmt_fetch(stmt);
+            if (rc != 0 && rc != MYSQL_DATA_TRUNCATED) {
+                break;
+            }
+            char row_buffer[4096];
+            int pos = 0;
+            row_buffer[0] = '\0';
+            for (int i = 0; i < num_fields && pos < (int)sizeof(row_buffer) - 1; i++) {
+                unsigned long len = lengths[i] < binds[i].buffer_length ? lengths[i] : binds[i].buffer_length - 1;
+                pos = append_column(row_buffer, pos, sizeof(row_buffer), i, fields[i].name,
+                                    nulls[i] ? NULL : (const char*)binds[i].buffer, len);
+            }
+            row_strings[(*row_count)++] = make_row_string(row_buffer, pos);
+        }
+    }
+
+    for (int i = 0; binds != NULL && i < num_fields; i++) {
+        free(binds[i].buffer);
+    }
+    free(binds);
+    free(lengths);
+    free(nulls);
+    mysql_free_result(meta);
+    mysql_stmt_free_result(stmt);
+    return ok ? 1 : -1;
+}
+
 /// MySQL 连接到数据库（适配 MoonBit FFI）
 /// 
 /// 参数：
@@ -214,126 +981,366 @@ int autumn_mysql_execute(int handle, moonbit_string_t sql) {
     
     const char* sql_str = get_c_string(sql);
     
+    // 优先使用缓存的预编译语句，无法预编译时使用文本协议
+    int prepared = stmt_cache_execute(handle, mysql, sql_str, &no_params, NULL, NULL);
+    if (prepared != 0) {
+        return prepared > 0 ? 0 : -1;
+    }
+    
     int rc = mysql_real_query(mysql, sql_str, strlen(sql_str));
+    if (rc == 0) {
+        mysql_last_affected[handle] = (long long)mysql_affected_rows(mysql);
+    }
     
     return rc;
 }
 
-/// MySQL 查询数据
+/// MySQL 执行带类型化参数的 SQL（通过语句缓存复用预编译结果）
 /// 
 /// 参数：
 /// - handle: 数据库连接句柄 ID
-/// - sql: SQL 查询语句（MoonBit String）
-/// - params: 参数数组（MoonBit Array[String]）
+/// - sql: SQL 语句（使用 ? 作为占位符）
+/// - params: 打包的参数（格式见“类型化参数”一节）
 /// 
 /// 返回：
-/// - 查询结果数组（MoonBit Array[String]），每行是一个字符串，列值用制表符分隔
-/// - 空数组表示查询失败或无结果
-// 返回 FixedArray[String] 而不是 Array[String]
-// FixedArray 在内存中是一块连续的 T 类型元素，可以直接传递给 C
-void** autumn_mysql_query(int handle, moonbit_string_t sql, void* params) {
-    fprintf(stderr, "DEBUG: autumn_mysql_query called with handle=%d\n", handle);
-    fflush(stderr);
-    
+/// - 0: 成功
+/// - 非0: 错误代码（参数格式错误或个数与占位符不一致时为 -1）
+int autumn_mysql_execute_params(int handle, moonbit_string_t sql, moonbit_bytes_t params) {
     MYSQL* mysql = get_mysql(handle);
-    void** results = moonbit_empty_ref_array;
-    
     if (mysql == NULL) {
-        fprintf(stderr, "DEBUG: mysql is NULL, returning empty array\n");
-        fflush(stderr);
-        return results;
+        return -1;
     }
-    
-    fprintf(stderr, "DEBUG: mysql is valid, proceeding with query\n");
-    fflush(stderr);
-    
-    // 转换 SQL 字符串
-    char sql_buffer[4096];
-    get_c_string_to_buffer(sql, sql_buffer, sizeof(sql_buffer));
-    
-    fprintf(stderr, "DEBUG: Executing SQL: %s\n", sql_buffer);
-    fflush(stderr);
-    
-    // 执行查询
-    if (mysql_real_query(mysql, sql_buffer, strlen(sql_buffer)) != 0) {
-        fprintf(stderr, "DEBUG: mysql_real_query failed: %s\n", mysql_error(mysql));
-        fflush(stderr);
-        return moonbit_empty_ref_array;
+    mysql_params bound;
+    if (!mysql_params_decode(&bound, params)) {
+        return -1;
     }
-    
-    // 获取结果集
-    MYSQL_RES* res = mysql_store_result(mysql);
-    if (res == NULL) {
-        fprintf(stderr, "DEBUG: mysql_store_result returned NULL, error: %s\n", mysql_error(mysql));
-        fflush(stderr);
-        return moonbit_empty_ref_array;
+
+    const char* sql_str = get_c_string(sql);
+    int prepared = stmt_cache_execute(handle, mysql, sql_str, &bound, NULL, NULL);
+    mysql_params_free(&bound);
+    if (prepared != 0) {
+        return prepared > 0 ? 0 : -1;
     }
+    int rc = mysql_real_query(mysql, sql_str, strlen(sql_str));
+    if (rc == 0) {
+        mysql_last_affected[handle] = (long long)mysql_affected_rows(mysql);
+    }
+    return rc;
+}
+
+// ========== 批量执行 ==========
+//
+// 整批在一个事务中执行（关闭 autocommit，最后提交一次，失败时整批回滚）。
+// 形如 INSERT INTO t (...) VALUES (?, ...) 的语句改写为多行 INSERT，
+// 每条语句携带最多 MAX_INSERT_ROWS 组参数；其他语句复用一个缓存的预编译语句逐组执行。
+
+#define MAX_INSERT_ROWS 1000
+#define MAX_STMT_PARAMS 65535
+
+// 批量执行的结果：每组参数影响的行数（u32 小端）
+static moonbit_bytes_t counts_bytes(const int* counts, int n) {
+    moonbit_bytes_t bytes = moonbit_make_bytes(n * 4, 0);
+    for (int i = 0; i < n; i++) {
+        for (int k = 0; k < 4; k++) {
+            bytes[i * 4 + k] = (uint8_t)((uint32_t)counts[i] >> (8 * k));
+        }
+    }
+    return bytes;
+}
+
+// 跳过引号内的内容（支持反斜杠转义），返回引号结束后的位置
+static size_t skip_quoted(const char* sql, size_t pos) {
+    char quote = sql[pos++];
+    while (sql[pos] != '\0' && sql[pos] != quote) {
+        if (sql[pos] == '\\' && quote != '`' && sql[pos + 1] != '\0') {
+            pos++;
+        }
+        pos++;
+    }
+    return sql[pos] == '\0' ? pos : pos + 1;
+}
+
+static int is_word_char(char c) {
+    return isalnum((unsigned char)c) || c == '_' || c == '$';
+}
+
+// 查找可以改写为多行 INSERT 的 VALUES 元组：语句必须以 "INSERT INTO" 开头，
+// 以唯一的元组结尾（INSERT IGNORE、ON DUPLICATE KEY UPDATE 等每行影响行数不确定，不改写）
+//
+// 返回 1 并写入元组的起止位置 [*start, *end)，不能改写时返回 0
+static int insert_values_tuple(const char* sql, size_t* start, size_t* end) {
+    size_t pos = 0;
+    while (isspace((unsigned char)sql[pos])) {
+        pos++;
+    }
+    if (strncasecmp(sql + pos, "INSERT", 6) != 0 || !isspace((unsigned char)sql[pos + 6])) {
+        return 0;
+    }
+    pos += 6;
+    while (isspace((unsigned char)sql[pos])) {
+        pos++;
+    }
+    if (strncasecmp(sql + pos, "INTO", 4) != 0 || is_word_char(sql[pos + 4])) {
+        return 0;
+    }
+
+    // 找到引号外的 VALUES / VALUE 关键字
+    size_t values = 0;
+    while (sql[pos] != '\0' && values == 0) {
+        char c = sql[pos];
+        if (c == '\'' || c == '"' || c == '`') {
+            pos = skip_quoted(sql, pos);
+        } else if (is_word_char(c)) {
+            size_t word = pos;
+            while (is_word_char(sql[pos])) {
+                pos++;
+            }
+            size_t len = pos - word;
+            if ((len == 6 && strncasecmp(sql + word, "VALUES", 6) == 0) ||
+                (len == 5 && strncasecmp(sql + word, "VALUE", 5) == 0)) {
+                values = pos;
+            }
+        } else {
+            pos++;
+        }
+    }
+    if (values == 0) {
+        return 0;
+    }
+
+    while (isspace((unsigned char)sql[pos])) {
+        pos++;
+    }
+    if (sql[pos] != '(') {
+        return 0;
+    }
+    *start = pos;
+    int depth = 0;
+    while (sql[pos] != '\0') {
+        char c = sql[pos];
+        if (c == '\'' || c == '"' || c == '`') {
+            pos = skip_quoted(sql, pos);
+            continue;
+        }
+        pos++;
+        if (c == '(') {
+            depth++;
+        } else if (c == ')' && --depth == 0) {
+            break;
+        }
+    }
+    if (depth != 0) {
+        return 0;
+    }
+    *end = pos;
+    while (isspace((unsigned char)sql[pos]) || sql[pos] == ';') {
+        pos++;
+    }
+    return sql[pos] == '\0';
+}
+
+// 构造 rows 行的 INSERT：原语句的元组之后重复追加 ",(...)"
+static char* build_multi_insert(const char* sql, size_t start, size_t end, int rows) {
+    size_t tuple = end - start;
+    char* text = malloc(end + (size_t)(rows - 1) * (tuple + 1) + 1);
+    if (text == NULL) {
+        return NULL;
+    }
+    memcpy(text, sql, end);
+    size_t pos = end;
+    for (int i = 1; i < rows; i++) {
+        text[pos++] = ',';
+        memcpy(text + pos, sql + start, tuple);
+        pos += tuple;
+    }
+    text[pos] = '\0';
+    return text;
+}
+
+// 以多行 INSERT 执行整批，成功时每组参数影响 1 行
+static int batch_multi_insert(int handle, MYSQL* mysql, const char* sql, size_t start, size_t end,
+                              param_reader* reader, int rows, int* counts) {
+    for (int done = 0; done < rows;) {
+        // 第一组参数的个数决定每行的占位符数，后续每组必须相同
+        param_reader peek = *reader;
+        int per_row = param_count(&peek);
+        if (per_row < 0) {
+            return 0;
+        }
+        int chunk = rows - done < MAX_INSERT_ROWS ? rows - done : MAX_INSERT_ROWS;
+        if (per_row > 0 && chunk > MAX_STMT_PARAMS / per_row) {
+            chunk = MAX_STMT_PARAMS / per_row;
+        }
+        if (chunk == 0) {
+            return 0;
+        }
+
+        mysql_params bound;
+        if (!mysql_params_alloc(&bound, chunk * per_row)) {
+            return 0;
+        }
+        int ok = 1;
+        for (int i = 0; ok && i < chunk; i++) {
+            ok = param_count(reader) == per_row && mysql_params_read(&bound, reader, i * per_row, per_row);
+        }
+        char* chunk_sql = ok ? build_multi_insert(sql, start, end, chunk) : NULL;
+        ok = chunk_sql != NULL && stmt_cache_execute(handle, mysql, chunk_sql, &bound, NULL, NULL) > 0;
+        free(chunk_sql);
+        mysql_params_free(&bound);
+        if (!ok) {
+            return 0;
+        }
+        for (int i = 0; i < chunk; i++) {
+            counts[done + i] = 1;
+        }
+        done += chunk;
+    }
+    return 1;
+}
+
+// 复用一个缓存的预编译语句逐组执行
+static int batch_each(int handle, MYSQL* mysql, const char* sql, param_reader* reader, int rows, int* counts) {
+    MYSQL_STMT* stmt = stmt_cache_acquire(handle, mysql, sql);
+    if (stmt == NULL) {
+        return 0;
+    }
+    for (int i = 0; i < rows; i++) {
+        mysql_params bound;
+        int count = param_count(reader);
+        if (count != (int)mysql_stmt_param_count(stmt) || !mysql_params_alloc(&bound, count)) {
+            return 0;
+        }
+        int ok = mysql_params_read(&bound, reader, 0, count) &&
+                 (count == 0 || !mysql_stmt_bind_param(stmt, bound.binds)) &&
+                 mysql_stmt_execute(stmt) == 0;
+        if (ok) {
+            counts[i] = (int)mysql_stmt_affected_rows(stmt);
+        }
+        mysql_stmt_free_result(stmt);
+        mysql_params_free(&bound);
+        if (!ok) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/// MySQL 批量执行同一条 SQL（整批在一个事务中执行，语句只预编译一次）
+/// 
+/// 参数：
+/// - handle: 数据库连接句柄 ID
+/// - sql: 单条 SQL 语句（使用 ? 作为占位符）
+/// - batch: 打包的多组参数（格式见“类型化参数”一节）
+/// 
+/// 返回：
+/// - 每组参数影响的行数（u32 小端数组）；任一组失败时回滚整批并返回空字节
+moonbit_bytes_t autumn_mysql_execute_batch(int handle, moonbit_string_t sql, moonbit_bytes_t batch) {
+    MYSQL* mysql = get_mysql(handle);
+    param_reader reader;
+    param_init(&reader, batch);
+    int rows = param_count(&reader);
+    if (mysql == NULL || rows <= 0) {
+        return counts_bytes(NULL, 0);
+    }
+    int* counts = malloc(rows * sizeof(int));
+    if (counts == NULL || mysql_autocommit(mysql, 0)) {
+        free(counts);
+        return counts_bytes(NULL, 0);
+    }
+
+    const char* sql_str = get_c_string(sql);
+    size_t start = 0;
+    size_t end = 0;
+    int ok = insert_values_tuple(sql_str, &start, &end)
+        ? batch_multi_insert(handle, mysql, sql_str, start, end, &reader, rows, counts)
+        : batch_each(handle, mysql, sql_str, &reader, rows, counts);
+    if (ok) {
+        ok = !mysql_commit(mysql);
+    }
+    if (!ok) {
+        mysql_rollback(mysql);
+    }
+    mysql_autocommit(mysql, 1);
+
+    moonbit_bytes_t result = counts_bytes(counts, ok ? rows : 0);
+    free(counts);
+    return result;
+}
+
+/// MySQL 查询数据
+/// 
+/// 参数：
+/// - handle: 数据库连接句柄 ID
+/// - sql: SQL 查询语句（MoonBit String）
+/// - params: 参数数组（MoonBit Array[String]）
+/// 
+/// 返回：
+/// - 查询结果数组（MoonBit Array[String]），每行是一个字符串，列值用制表符分隔
+/// - 空数组表示查询失败或无结果
+// 返回 FixedArray[String] 而不是 Array[String]
+// FixedArray 在内存中是一块连续的 T 类型元素，可以直接传递给 C
+void** autumn_mysql_query(int handle, moonbit_string_t sql, void* params) {
+    fprintf(stderr, "DEBUG: autumn_mysql_query called with handle=%d\n", handle);
+    fflush(stderr);
     
-    // 获取字段数和字段信息
-    int num_fields = mysql_num_fields(res);
-    MYSQL_FIELD* fields = mysql_fetch_fields(res);
+    MYSQL* mysql = get_mysql(handle);
+    void** results = moonbit_empty_ref_array;
     
-    fprintf(stderr, "DEBUG: Query executed successfully, num_fields=%d\n", num_fields);
+    if (mysql == NULL) {
+        fprintf(stderr, "DEBUG: mysql is NULL, returning empty array\n");
+        fflush(stderr);
+        return results;
+    }
+    
+    fprintf(stderr, "DEBUG: mysql is valid, proceeding with query\n");
     fflush(stderr);
     
-    // 先收集所有行数据到临时数组
-    #define MAX_ROWS 1000
-    moonbit_string_t row_strings[MAX_ROWS];
-    int row_count = 0;
+    // 转换 SQL 字符串
+    char sql_buffer[4096];
+    get_c_string_to_buffer(sql, sql_buffer, sizeof(sql_buffer));
     
-    // 遍历结果集
-    MYSQL_ROW row;
-    fprintf(stderr, "DEBUG: Starting to fetch rows...\n");
+    fprintf(stderr, "DEBUG: Executing SQL: %s\n", sql_buffer);
     fflush(stderr);
-    while ((row = mysql_fetch_row(res)) != NULL && row_count < MAX_ROWS) {
-        if (row_count == 0) {
-            fprintf(stderr, "DEBUG: First row fetched\n");
+    
+    // 优先使用缓存的预编译语句（命中时不再预编译），无法预编译时使用文本协议
+    moonbit_string_t row_strings[MAX_ROWS];
+    int row_count = 0;
+    int prepared = stmt_cache_execute(handle, mysql, sql_buffer, &no_params, row_strings, &row_count);
+    if (prepared < 0) {
+        fprintf(stderr, "DEBUG: prepared statement failed: %s\n", mysql_error(mysql));
+        fflush(stderr);
+        return moonbit_empty_ref_array;
+    }
+    if (prepared == 0) {
+        if (mysql_real_query(mysql, sql_buffer, strlen(sql_buffer)) != 0) {
+            fprintf(stderr, "DEBUG: mysql_real_query failed: %s\n", mysql_error(mysql));
             fflush(stderr);
+            return moonbit_empty_ref_array;
         }
-        // 构建一行数据（格式：column1=value1\tcolumn2=value2\t...）
-        char row_buffer[4096] = {0};
-        int pos = 0;
         
-        for (int i = 0; i < num_fields && pos < sizeof(row_buffer) - 1; i++) {
-            if (i > 0 && pos < sizeof(row_buffer) - 1) {
-                row_buffer[pos++] = '\t';
-            }
-            
-            // 添加列名
-            if (fields[i].name != NULL) {
-                int name_len = strlen(fields[i].name);
-                if (pos + name_len + 1 < sizeof(row_buffer)) {
-                    strncpy(row_buffer + pos, fields[i].name, sizeof(row_buffer) - pos - 1);
-                    pos += name_len;
-                    row_buffer[pos++] = '=';
-                }
-            }
-            
-            // 添加列值
-            if (row[i] != NULL) {
-                int value_len = strlen(row[i]);
-                if (pos + value_len < sizeof(row_buffer)) {
-                    strncpy(row_buffer + pos, row[i], sizeof(row_buffer) - pos - 1);
-                    pos += value_len;
-                }
-            }
+        MYSQL_RES* res = mysql_store_result(mysql);
+        if (res == NULL) {
+            fprintf(stderr, "DEBUG: mysql_store_result returned NULL, error: %s\n", mysql_error(mysql));
+            fflush(stderr);
+            return moonbit_empty_ref_array;
         }
         
-        // 创建 MoonBit String
-        int str_len = strlen(row_buffer);
-        moonbit_string_t row_str = moonbit_make_string_raw(str_len + 1);
-        for (int i = 0; i < str_len; i++) {
-            row_str[i] = (uint16_t)(unsigned char)row_buffer[i];
+        int num_fields = mysql_num_fields(res);
+        MYSQL_FIELD* fields = mysql_fetch_fields(res);
+        MYSQL_ROW row;
+        while ((row = mysql_fetch_row(res)) != NULL && row_count < MAX_ROWS) {
+            unsigned long* lengths = mysql_fetch_lengths(res);
+            char row_buffer[4096];
+            int pos = 0;
+            row_buffer[0] = '\0';
+            for (int i = 0; i < num_fields && pos < (int)sizeof(row_buffer) - 1; i++) {
+                pos = append_column(row_buffer, pos, sizeof(row_buffer), i, fields[i].name, row[i], lengths[i]);
+            }
+            row_strings[row_count++] = make_row_string(row_buffer, pos);
         }
-        row_str[str_len] = 0;
-        
-        // 保存到临时数组
-        row_strings[row_count++] = row_str;
+        mysql_free_result(res);
     }
     
-    // 释放结果集
-    mysql_free_result(res);
-    
     // 创建结果数组
     fprintf(stderr, "DEBUG: About to create array, row_count=%d\n", row_count);
     fflush(stderr);
@@ -452,6 +1459,775 @@ void** autumn_mysql_query(int handle, moonbit_string_t sql, void* params) {
     }
 }
 
+// ========== 流式游标 ==========
+//
+// 游标使用 mysql_use_result 逐行从服务器读取结果，客户端不缓存整个结果集。
+// 带参数的查询使用单独预编译的语句（不进入语句缓存，游标读取期间语句不能被复用），
+// 同样不调用 mysql_stmt_store_result，逐行读取。
+// 协议限制：结果集读完（或游标关闭）之前，同一连接不能执行其他语句，
+// 因此每个连接同时只允许一个游标。
+
+#define MAX_CURSORS 64
+
+typedef struct {
+    int handle;           // 所属连接，-1 表示空槽位
+    MYSQL_RES* result;    // 流式结果集或预编译语句的结果元数据（语句没有结果集时为 NULL）
+    int done;             // 0 读取中，1 结果集已读完，2 出错
+    MYSQL_STMT* stmt;     // 带参数查询的预编译语句（文本协议时为 NULL）
+    MYSQL_BIND* binds;    // 预编译语句的结果缓冲区（按文本取回，截断时扩容）
+    int bind_count;
+    unsigned long* lengths;
+    mysql_flag_t* nulls;
+} mysql_cursor;
+
+static mysql_cursor cursors[MAX_CURSORS];
+static int cursors_initialized = 0;
+
+static mysql_cursor* get_cursor(int cursor) {
+    if (cursor >= 0 && cursor < MAX_CURSORS && cursors_initialized && cursors[cursor].handle >= 0) {
+        return &cursors[cursor];
+    }
+    return NULL;
+}
+
+// 释放游标（mysql_free_result 会读完并丢弃剩余的行，连接随后可以继续使用）
+static void cursor_release(mysql_cursor* cursor) {
+    if (cursor->result != NULL) {
+        mysql_free_result(cursor->result);
+    }
+    if (cursor->stmt != NULL) {
+        mysql_stmt_free_result(cursor->stmt);
+        mysql_stmt_close(cursor->stmt);
+    }
+    for (int i = 0; cursor->binds != NULL && i < cursor->bind_count; i++) {
+        free(cursor->binds[i].buffer);
+    }
+    free(cursor->binds);
+    free(cursor->lengths);
+    free(cursor->nulls);
+    cursor->result = NULL;
+    cursor->stmt = NULL;
+    cursor->binds = NULL;
+    cursor->bind_count = 0;
+    cursor->lengths = NULL;
+    cursor->nulls = NULL;
+    cursor->handle = -1;
+    cursor->done = 0;
+}
+
+// 关闭连接上未关闭的游标（关闭连接前调用）
+static void cursor_close_all(int handle) {
+    for (int i = 0; cursors_initialized && i < MAX_CURSORS; i++) {
+        if (cursors[i].handle == handle) {
+            cursor_release(&cursors[i]);
+        }
+    }
+}
+
+// 字段对应的单元格类型：整数和浮点数按数值返回，二进制字符集的字符串按二进制返回，
+// 其余（包括 DECIMAL 和超出 Int64 范围的 BIGINT UNSIGNED）按文本返回以保留精度
+static int mysql_field_cell_type(const MYSQL_FIELD* field) {
+    switch (field->type) {
+        case MYSQL_TYPE_TINY:
+        case MYSQL_TYPE_SHORT:
+        case MYSQL_TYPE_LONG:
+        case MYSQL_TYPE_INT24:
+        case MYSQL_TYPE_YEAR:
+            return CELL_INT;
+        case MYSQL_TYPE_LONGLONG:
+            return (field->flags & UNSIGNED_FLAG) ? CELL_TEXT : CELL_INT;
+        case MYSQL_TYPE_FLOAT:
+        case MYSQL_TYPE_DOUBLE:
+            return CELL_REAL;
+        case MYSQL_TYPE_BIT:
+        case MYSQL_TYPE_GEOMETRY:
+            return CELL_BLOB;
+        case MYSQL_TYPE_TINY_BLOB:
+        case MYSQL_TYPE_MEDIUM_BLOB:
+        case MYSQL_TYPE_LONG_BLOB:
+        case MYSQL_TYPE_BLOB:
+        case MYSQL_TYPE_STRING:
+        case MYSQL_TYPE_VAR_STRING:
+            return field->charsetnr == 63 ? CELL_BLOB : CELL_TEXT; // 63 = binary
+        default:
+            return CELL_TEXT;
+    }
+}
+
+// 按字段类型写入一个非 NULL 的值（data 不要求以 NUL 结尾）
+static void batch_mysql_value(batch_builder* batch, int column, const MYSQL_FIELD* field,
+                              const char* data, size_t len) {
+    int type = mysql_field_cell_type(field);
+    if (type == CELL_INT || type == CELL_REAL) {
+        char number[64];
+        size_t n = len < sizeof(number) - 1 ? len : sizeof(number) - 1;
+        memcpy(number, data, n);
+        number[n] = '\0';
+        if (type == CELL_INT) {
+            batch_int(batch, column, (int64_t)strtoll(number, NULL, 10));
+        } else {
+            batch_real(batch, column, strtod(number, NULL));
+        }
+    } else {
+        batch_bytes(batch, column, type, data, len);
+    }
+}
+
+// 预编译并执行带参数的查询，结果缓冲区绑定到游标；失败时返回 0
+static int cursor_open_prepared(mysql_cursor* cursor, MYSQL* mysql, const char* sql,
+                                const mysql_params* params) {
+    MYSQL_STMT* stmt = mysql_stmt_init(mysql);
+    if (stmt == NULL) {
+        return 0;
+    }
+    if (mysql_stmt_prepare(stmt, sql, strlen(sql)) != 0 ||
+        (int)mysql_stmt_param_count(stmt) != params->count ||
+        mysql_stmt_bind_param(stmt, params->binds) ||
+        mysql_stmt_execute(stmt) != 0) {
+        mysql_stmt_close(stmt);
+        return 0;
+    }
+    cursor->stmt = stmt;
+    cursor->result = mysql_stmt_result_metadata(stmt);
+    if (cursor->result == NULL) {
+        return 1;
+    }
+
+    int columns = (int)mysql_num_fields(cursor->result);
+    cursor->binds = calloc(columns, sizeof(MYSQL_BIND));
+    cursor->lengths = calloc(columns, sizeof(unsigned long));
+    cursor->nulls = calloc(columns, sizeof(mysql_flag_t));
+    int ok = cursor->binds != NULL && cursor->lengths != NULL && cursor->nulls != NULL;
+    cursor->bind_count = ok ? columns : 0;
+    for (int i = 0; ok && i < columns; i++) {
+        cursor->binds[i].buffer_type = MYSQL_TYPE_STRING;
+        cursor->binds[i].buffer = malloc(256);
+        cursor->binds[i].buffer_length = 256;
+        cursor->binds[i].length = &cursor->lengths[i];
+        cursor->binds[i].is_null = &cursor->nulls[i];
+        ok = cursor->binds[i].buffer != NULL;
+    }
+    return ok && !mysql_stmt_bind_result(stmt, cursor->binds);
+}
+
+// 从文本协议的结果集读取一行写入批次；没有更多行时设置 done 并返回 0
+static int cursor_read_row(mysql_cursor* cursor, batch_builder* batch, MYSQL_FIELD* fields, int columns) {
+    MYSQL_ROW row = mysql_fetch_row(cursor->result);
+    if (row == NULL) {
+        cursor->done = mysql_errno(mysql_handles[cursor->handle]) == 0 ? 1 : 2;
+        return 0;
+    }
+    unsigned long* lengths = mysql_fetch_lengths(cursor->result);
+    for (int i = 0; i < columns; i++) {
+        if (row[i] == NULL) {
+            batch_null(batch, i);
+        } else {
+            batch_mysql_value(batch, i, &fields[i], row[i], (size_t)lengths[i]);
+        }
+    }
+    return 1;
+}
+
+// 从预编译语句读取一行写入批次（值超出缓冲区时扩容后重新取该列）；
+// 没有更多行时设置 done 并返回 0
+static int cursor_read_stmt_row(mysql_cursor* cursor, batch_builder* batch, MYSQL_FIELD* fields, int columns) {
+    int rc = mysql_stmt_fetch(cursor->stmt);
+    if (rc == MYSQL_NO_DATA) {
+        cursor->done = 1;
+        return 0;
+    }
+    if (rc != 0 && rc != MYSQL_DATA_TRUNCATED) {
+        cursor->done = 2;
+        return 0;
+    }
+    int rebind = 0;
+    for (int i = 0; i < columns; i++) {
+        if (cursor->nulls[i]) {
+            batch_null(batch, i);
+            continue;
+        }
+        MYSQL_BIND* bind = &cursor->binds[i];
+        unsigned long len = cursor->lengths[i];
+        if (len > bind->buffer_length) {
+            void* grown = realloc(bind->buffer, len + 1);
+            if (grown == NULL) {
+                cursor->done = 2;
+                return 0;
+            }
+            bind->buffer = grown;
+            bind->buffer_length = len + 1;
+            if (mysql_stmt_fetch_column(cursor->stmt, bind, i, 0) != 0) {
+                cursor->done = 2;
+                return 0;
+            }
+            rebind = 1;
+        }
+        batch_mysql_value(batch, i, &fields[i], (const char*)bind->buffer, (size_t)len);
+    }
+    if (rebind && mysql_stmt_bind_result(cursor->stmt, cursor->binds)) {
+        cursor->done = 2;
+    }
+    return 1;
+}
+
+// 以文本协议执行查询，逐行读取的结果集绑定到游标（语句没有结果集时为 NULL）；失败时返回 0
+static int cursor_open_text(mysql_cursor* cursor, MYSQL* mysql, const char* sql) {
+    if (mysql_real_query(mysql, sql, strlen(sql)) != 0) {
+        return 0;
+    }
+    MYSQL_RES* result = mysql_use_result(mysql);
+    if (result == NULL && mysql_field_count(mysql) != 0) {
+        return 0;
+    }
+    cursor->result = result;
+    return 1;
+}
+
+// 从游标读取最多 limit 行写入批次（读完或出错时设置 done）
+static void cursor_fill_batch(mysql_cursor* cursor, batch_builder* batch, MYSQL_FIELD* fields, int columns, int limit) {
+    while (!cursor->done && batch->rows < limit && !batch->failed) {
+        int read = cursor->stmt != NULL
+            ? cursor_read_stmt_row(cursor, batch, fields, columns)
+            : cursor_read_row(cursor, batch, fields, columns);
+        if (!read) {
+            break;
+        }
+        batch_end_row(batch);
+    }
+}
+
+static void field_names(const MYSQL_FIELD* fields, int columns, const char** names) {
+    for (int i = 0; i < columns; i++) {
+        names[i] = fields[i].name;
+    }
+}
+
+/// MySQL 打开流式游标（适配 MoonBit FFI）
+/// 
+/// 参数：
+/// - handle: 数据库连接句柄 ID
+/// - sql: SQL 查询语句（MoonBit String）
+/// - params: 打包的参数（格式见“类型化参数”一节；没有参数时使用文本协议）
+/// 
+/// 返回：
+/// - >= 0: 游标 ID
+/// - < 0: 失败（连接无效、连接上已有游标、SQL 错误、参数不匹配或游标表已满）
+int autumn_mysql_cursor_open(int handle, moonbit_string_t sql, moonbit_bytes_t params) {
+    MYSQL* mysql = get_mysql(handle);
+    if (mysql == NULL) {
+        return -1;
+    }
+    if (!cursors_initialized) {
+        for (int i = 0; i < MAX_CURSORS; i++) {
+            memset(&cursors[i], 0, sizeof(mysql_cursor));
+            cursors[i].handle = -1;
+        }
+        cursors_initialized = 1;
+    }
+    int slot = -1;
+    for (int i = 0; i < MAX_CURSORS; i++) {
+        if (cursors[i].handle == handle) {
+            return -1; // 连接上已有未关闭的游标
+        }
+        if (slot < 0 && cursors[i].handle < 0) {
+            slot = i;
+        }
+    }
+    if (slot < 0) {
+        return -1;
+    }
+
+    mysql_params bound;
+    if (!mysql_params_decode(&bound, params)) {
+        return -1;
+    }
+    const char* sql_str = get_c_string(sql);
+    if (bound.count > 0) {
+        int ok = cursor_open_prepared(&cursors[slot], mysql, sql_str, &bound);
+        mysql_params_free(&bound);
+        if (!ok) {
+            cursor_release(&cursors[slot]);
+            return -1;
+        }
+        cursors[slot].handle = handle;
+        cursors[slot].done = cursors[slot].result == NULL ? 1 : 0;
+        return slot;
+    }
+
+    if (!cursor_open_text(&cursors[slot], mysql, sql_str)) {
+        return -1;
+    }
+    cursors[slot].handle = handle;
+    cursors[slot].done = cursors[slot].result == NULL ? 1 : 0;
+    return slot;
+}
+
+/// MySQL 从游标读取下一批行（适配 MoonBit FFI）
+/// 
+/// 参数：
+/// - cursor: 游标 ID
+/// - max_rows: 本批最多读取的行数（<= 0 时使用默认值 256）
+/// 
+/// 返回：
+/// - 列式批次（格式见“列式结果批次”一节）；游标无效时返回状态为出错的空批次
+moonbit_bytes_t autumn_mysql_cursor_fetch(int cursor, int max_rows) {
+    mysql_cursor* entry = get_cursor(cursor);
+    if (entry == NULL) {
+        return batch_empty(2);
+    }
+    if (entry->result == NULL) {
+        return batch_empty(entry->done);
+    }
+    MYSQL_RES* result = entry->result;
+    int columns = (int)mysql_num_fields(result);
+    MYSQL_FIELD* fields = mysql_fetch_fields(result);
+    int limit = batch_rows_limit(max_rows);
+
+    batch_builder batch;
+    if (!batch_init(&batch, columns)) {
+        return batch_empty(2);
+    }
+    cursor_fill_batch(entry, &batch, fields, columns, limit);
+    int status = entry->done;
+
+    const char* names[columns > 0 ? columns : 1];
+    field_names(fields, columns, names);
+    moonbit_bytes_t bytes = batch_finish(&batch, status, names);
+    batch_free(&batch);
+    return bytes;
+}
+
+/// MySQL 关闭游标（适配 MoonBit FFI）
+/// 
+/// 返回：
+/// - 0: 成功
+/// - -1: 游标无效（已关闭）
+int autumn_mysql_cursor_close(int cursor) {
+    mysql_cursor* entry = get_cursor(cursor);
+    if (entry == NULL) {
+        return -1;
+    }
+    cursor_release(entry);
+    return 0;
+}
+
+// ========== 后台工作线程池 ==========
+//
+// 异步接口让事件循环（AsyncServer）不被阻塞的数据库调用卡住：
+// 提交时把 SQL 和打包参数复制到 C 堆上排队，由工作线程执行，
+// 结果编码为列式批次暂存在任务中；调用方轮询任务状态（或等待 eventfd 可读）后再取回。
+//
+// - 同一连接上的任务按提交顺序串行执行，不同连接上的任务并行执行
+// - 工作线程不接触 MoonBit 对象，MoonBit Bytes 只在取回结果时由调用线程创建
+// - 连接上还有未完成的任务时，调用方不能再同步使用这个连接；关闭连接会先等待这些任务完成
+//
+// 查询任务的结果是包含全部行的批次（状态 1）；执行任务的结果是空批次，状态 1 成功、2 出错。
+
+#define MAX_JOBS 256
+#define DEFAULT_WORKERS 4
+#define MAX_WORKERS 64
+
+#define JOB_FREE 0
+#define JOB_QUEUED 1
+#define JOB_RUNNING 2
+#define JOB_DONE 3
+
+typedef struct async_job {
+    int state;
+    int handle;
+    void* conn;           // 连接（提交时取出，工作线程不再查句柄表）
+    int query;            // 1 查询，0 执行
+    int discarded;        // 调用方已放弃，执行完直接回收
+    char* sql;
+    uint8_t* params;      // 打包参数的副本
+    size_t params_len;
+    byte_buf result;      // 编码好的列式批次
+    struct async_job* next;
+} async_job;
+
+static async_job jobs[MAX_JOBS];
+static async_job* queue_head = NULL;
+static async_job* queue_tail = NULL;
+static int handle_busy[MAX_HANDLES];
+static pthread_mutex_t jobs_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobs_changed = PTHREAD_COND_INITIALIZER;
+static int worker_count = 0;
+static int event_fd = -1;
+
+// 由各包装层实现：工作线程初始化、执行一个任务
+static void async_worker_init(void);
+static void async_run(async_job* job);
+
+static void job_reset(async_job* job) {
+    free(job->sql);
+    free(job->params);
+    buf_free(&job->result);
+    memset(job, 0, sizeof(*job));
+}
+
+// 从队列中摘下任务（调用时持有 jobs_lock）
+static void async_unlink(async_job* target) {
+    async_job* prev = NULL;
+    for (async_job* job = queue_head; job != NULL; prev = job, job = job->next) {
+        if (job == target) {
+            if (prev == NULL) {
+                queue_head = job->next;
+            } else {
+                prev->next = job->next;
+            }
+            if (queue_tail == job) {
+                queue_tail = prev;
+            }
+            job->next = NULL;
+            return;
+        }
+    }
+}
+
+// 取出第一个所属连接空闲的任务（调用时持有 jobs_lock）
+// 同一连接的任务在队列中保持提交顺序，所以取到的总是该连接最早的任务
+static async_job* async_dequeue(void) {
+    for (async_job* job = queue_head; job != NULL; job = job->next) {
+        if (!handle_busy[job->handle]) {
+            async_unlink(job);
+            return job;
+        }
+    }
+    return NULL;
+}
+
+static void* async_worker(void* arg) {
+    (void)arg;
+    async_worker_init();
+    pthread_mutex_lock(&jobs_lock);
+    for (;;) {
+        async_job* job = async_dequeue();
+        if (job == NULL) {
+            pthread_cond_wait(&jobs_changed, &jobs_lock);
+            continue;
+        }
+        job->state = JOB_RUNNING;
+        handle_busy[job->handle] = 1;
+        pthread_mutex_unlock(&jobs_lock);
+
+        async_run(job);
+
+        pthread_mutex_lock(&jobs_lock);
+        handle_busy[job->handle] = 0;
+        if (job->discarded) {
+            job_reset(job);
+        } else {
+            job->state = JOB_DONE;
+        }
+        // 唤醒等待同一连接的工作线程和 async_wait_idle
+        pthread_cond_broadcast(&jobs_changed);
+        if (event_fd >= 0) {
+            uint64_t one = 1;
+            ssize_t written = write(event_fd, &one, sizeof(one));
+            (void)written;
+        }
+    }
+    return NULL;
+}
+
+// 启动工作线程（调用时持有 jobs_lock），已启动时不再增加，返回工作线程数
+static int async_start_locked(int threads) {
+    if (worker_count > 0) {
+        return worker_count;
+    }
+    if (threads <= 0) {
+        threads = DEFAULT_WORKERS;
+    }
+    if (threads > MAX_WORKERS) {
+        threads = MAX_WORKERS;
+    }
+    if (event_fd < 0) {
+        event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, async_worker, NULL) != 0) {
+            break;
+        }
+        pthread_detach(thread);
+        worker_count++;
+    }
+    return worker_count;
+}
+
+// 复制 SQL 和参数并排队，返回任务 ID，失败时返回 -1（在调用线程中使用）
+static int async_submit(int handle, void* conn, const char* sql, moonbit_bytes_t params, int query) {
+    size_t len = params == NULL ? 0 : Moonbit_array_length(params);
+    char* sql_copy = strdup(sql);
+    uint8_t* params_copy = len > 0 ? (uint8_t*)malloc(len) : NULL;
+    if (sql_copy == NULL || (len > 0 && params_copy == NULL)) {
+        free(sql_copy);
+        free(params_copy);
+        return -1;
+    }
+    if (len > 0) {
+        memcpy(params_copy, params, len);
+    }
+
+    pthread_mutex_lock(&jobs_lock);
+    int slot = -1;
+    if (async_start_locked(0) > 0) {
+        for (int i = 0; i < MAX_JOBS; i++) {
+            if (jobs[i].state == JOB_FREE) {
+                slot = i;
+                break;
+            }
+        }
+    }
+    if (slot < 0) {
+        pthread_mutex_unlock(&jobs_lock);
+        free(sql_copy);
+        free(params_copy);
+        return -1;
+    }
+    async_job* job = &jobs[slot];
+    job->state = JOB_QUEUED;
+    job->handle = handle;
+    job->conn = conn;
+    job->query = query;
+    job->sql = sql_copy;
+    job->params = params_copy;
+    job->params_len = len;
+    if (queue_tail == NULL) {
+        queue_head = job;
+    } else {
+        queue_tail->next = job;
+    }
+    queue_tail = job;
+    pthread_cond_broadcast(&jobs_changed);
+    pthread_mutex_unlock(&jobs_lock);
+    return slot;
+}
+
+static async_job* get_job(int job) {
+    if (job >= 0 && job < MAX_JOBS && jobs[job].state != JOB_FREE && !jobs[job].discarded) {
+        return &jobs[job];
+    }
+    return NULL;
+}
+
+// 返回 1 已完成，0 排队或执行中，-1 任务无效
+static int async_poll(int id) {
+    pthread_mutex_lock(&jobs_lock);
+    async_job* job = get_job(id);
+    int result = job == NULL ? -1 : job->state == JOB_DONE;
+    pthread_mutex_unlock(&jobs_lock);
+    return result;
+}
+
+// 取回已完成任务的结果并回收任务，任务无效或未完成时返回状态为出错的空批次
+static moonbit_bytes_t async_take(int id) {
+    pthread_mutex_lock(&jobs_lock);
+    async_job* job = get_job(id);
+    if (job == NULL || job->state != JOB_DONE) {
+        pthread_mutex_unlock(&jobs_lock);
+        return batch_empty(2);
+    }
+    byte_buf result = job->result;
+    memset(&job->result, 0, sizeof(job->result));
+    job_reset(job);
+    pthread_mutex_unlock(&jobs_lock);
+    if (result.len == 0) {
+        buf_free(&result);
+        return batch_empty(2);
+    }
+    return buf_take_bytes(&result);
+}
+
+// 放弃任务：排队中的直接移除，执行中的等执行完再回收，返回 -1 表示任务无效
+static int async_discard(int id) {
+    pthread_mutex_lock(&jobs_lock);
+    async_job* job = get_job(id);
+    if (job == NULL) {
+        pthread_mutex_unlock(&jobs_lock);
+        return -1;
+    }
+    if (job->state == JOB_RUNNING) {
+        job->discarded = 1;
+    } else {
+        if (job->state == JOB_QUEUED) {
+            async_unlink(job);
+        }
+        job_reset(job);
+        pthread_cond_broadcast(&jobs_changed);
+    }
+    pthread_mutex_unlock(&jobs_lock);
+    return 0;
+}
+
+static int async_pending(int handle) {
+    for (int i = 0; i < MAX_JOBS; i++) {
+        if (jobs[i].handle == handle && (jobs[i].state == JOB_QUEUED || jobs[i].state == JOB_RUNNING)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 等待连接上排队和执行中的任务全部完成（关闭连接前调用）
+static void async_wait_idle(int handle) {
+    pthread_mutex_lock(&jobs_lock);
+    while (async_pending(handle)) {
+        pthread_cond_wait(&jobs_changed, &jobs_lock);
+    }
+    pthread_mutex_unlock(&jobs_lock);
+}
+
+static int async_event_fd(void) {
+    pthread_mutex_lock(&jobs_lock);
+    async_start_locked(0);
+    int fd = event_fd;
+    pthread_mutex_unlock(&jobs_lock);
+    return fd;
+}
+
+// 开始读取任务的参数，返回参数个数（没有参数时为 0），格式错误时返回 -1
+static int async_params(async_job* job, param_reader* reader) {
+    param_init_range(reader, job->params, job->params_len);
+    return reader->pos == reader->end ? 0 : param_count(reader);
+}
+
+// 任务结果为只有状态的空批次
+static void async_result_status(async_job* job, int status) {
+    buf_free(&job->result);
+    buf_byte(&job->result, (uint8_t)status);
+    buf_u32(&job->result, 0);
+    buf_u32(&job->result, 0);
+}
+
+static void async_worker_init(void) {
+    // 每个使用 libmysqlclient 的线程都要先初始化线程局部状态
+    mysql_thread_init();
+}
+
+// 在工作线程中执行任务，结果写入 job->result
+static void async_run(async_job* job) {
+    MYSQL* mysql = (MYSQL*)job->conn;
+    param_reader reader;
+    int count = async_params(job, &reader);
+    mysql_params bound;
+    if (count < 0 || !mysql_params_alloc(&bound, count)) {
+        async_result_status(job, 2);
+        return;
+    }
+    if (!mysql_params_read(&bound, &reader, 0, count)) {
+        mysql_params_free(&bound);
+        async_result_status(job, 2);
+        return;
+    }
+    if (!job->query) {
+        int prepared = stmt_cache_execute(job->handle, mysql, job->sql, &bound, NULL, NULL);
+        mysql_params_free(&bound);
+        int ok = prepared != 0 ? prepared > 0 : mysql_real_query(mysql, job->sql, strlen(job->sql)) == 0;
+        if (ok && prepared == 0) {
+            mysql_last_affected[job->handle] = (long long)mysql_affected_rows(mysql);
+        }
+        async_result_status(job, ok ? 1 : 2);
+        return;
+    }
+
+    mysql_cursor cursor;
+    memset(&cursor, 0, sizeof(cursor));
+    cursor.handle = job->handle;
+    int ok = bound.count > 0
+        ? cursor_open_prepared(&cursor, mysql, job->sql, &bound)
+        : cursor_open_text(&cursor, mysql, job->sql);
+    mysql_params_free(&bound);
+    int encoded = 0;
+    if (ok && cursor.result != NULL) {
+        int columns = (int)mysql_num_fields(cursor.result);
+        MYSQL_FIELD* fields = mysql_fetch_fields(cursor.result);
+        batch_builder batch;
+        if (batch_init(&batch, columns)) {
+            cursor_fill_batch(&cursor, &batch, fields, columns, INT_MAX);
+            const char* names[columns > 0 ? columns : 1];
+            field_names(fields, columns, names);
+            encoded = cursor.done == 1 && batch_encode(&batch, 1, names, &job->result);
+            batch_free(&batch);
+        }
+    }
+    cursor_release(&cursor);
+    if (!encoded) {
+        // 没有结果集的语句按成功返回空批次
+        async_result_status(job, ok && cursor.result == NULL ? 1 : 2);
+    }
+}
+
+/// MySQL 启动后台工作线程（适配 MoonBit FFI）
+/// 
+/// 参数：
+/// - threads: 工作线程数，<= 0 时使用默认值；已启动时忽略
+/// 
+/// 返回：
+/// - 工作线程数，0 表示无法创建线程
+int autumn_mysql_async_start(int threads) {
+    pthread_mutex_lock(&jobs_lock);
+    int count = async_start_locked(threads);
+    pthread_mutex_unlock(&jobs_lock);
+    return count;
+}
+
+/// MySQL 提交异步任务，由工作线程执行（适配 MoonBit FFI）
+/// 
+/// 参数：
+/// - handle: 数据库连接句柄 ID
+/// - sql: SQL 语句（使用 ? 作为占位符）
+/// - params: 打包的参数（格式见“类型化参数”一节）
+/// - query: 1 查询（结果为全部行），0 执行
+/// 
+/// 返回：
+/// - >= 0: 任务 ID
+/// - -1: 失败（连接无效或任务表已满）
+int autumn_mysql_async_submit(int handle, moonbit_string_t sql, moonbit_bytes_t params, int query) {
+    MYSQL* mysql = get_mysql(handle);
+    if (mysql == NULL) {
+        return -1;
+    }
+    return async_submit(handle, mysql, get_c_string(sql), params, query);
+}
+
+/// MySQL 查询异步任务状态（适配 MoonBit FFI）
+/// 
+/// 返回：
+/// - 1: 已完成，可以取回结果
+/// - 0: 排队或执行中
+/// - -1: 任务无效
+int autumn_mysql_async_poll(int job) {
+    return async_poll(job);
+}
+
+/// MySQL 取回异步任务的结果并释放任务（适配 MoonBit FFI）
+/// 
+/// 返回：
+/// - 列式批次（格式见“列式结果批次”一节）；任务无效或未完成时返回状态为出错的空批次
+moonbit_bytes_t autumn_mysql_async_take(int job) {
+    return async_take(job);
+}
+
+/// MySQL 放弃异步任务（适配 MoonBit FFI）
+/// 
+/// 返回：
+/// - 0: 成功（执行中的任务完成后释放）
+/// - -1: 任务无效
+int autumn_mysql_async_discard(int job) {
+    return async_discard(job);
+}
+
+/// MySQL 获取任务完成通知的 eventfd（适配 MoonBit FFI）
+/// 
+/// 每完成一个任务计数加 1，可以交给支持文件描述符的事件循环等待可读
+/// 
+/// 返回：
+/// - 文件描述符，-1 表示不可用
+int autumn_mysql_async_event_fd(void) {
+    return async_event_fd();
+}
+
 /// MySQL 关闭数据库连接（适配 MoonBit FFI）
 /// 
 /// 参数：
@@ -466,11 +2242,37 @@ int autumn_mysql_close(int handle) {
         return -1;
     }
     
+    // 先等后台任务完成，再关闭游标和缓存的预编译语句
+    async_wait_idle(handle);
+    cursor_close_all(handle);
+    stmt_cache_clear(handle);
     mysql_close(mysql);
     remove_mysql(handle);
     return 0;
 }
 
+/// MySQL 获取语句缓存的统计信息（适配 MoonBit FFI）
+/// 
+/// 参数：
+/// - handle: 数据库连接句柄 ID
+/// - stat: 0 命中次数，1 未命中次数，2 当前条目数，3 淘汰次数
+/// 
+/// 返回：
+/// - 统计值，句柄无效时返回 -1
+int autumn_mysql_stmt_cache_stat(int handle, int stat) {
+    if (get_mysql(handle) == NULL) {
+        return -1;
+    }
+    stmt_cache* cache = &stmt_caches[handle];
+    switch (stat) {
+        case 0: return cache->hits;
+        case 1: return cache->misses;
+        case 2: return cache->size;
+        case 3: return cache->evictions;
+        default: return -1;
+    }
+}
+
 /// MySQL 获取最后的错误信息（适配 MoonBit FFI）
 /// 
 /// 参数：
@@ -501,3 +2303,37 @@ moonbit_string_t autumn_mysql_errmsg(int handle) {
     return result;
 }
 
+/// MySQL 获取最后的错误码（适配 MoonBit FFI）
+/// 
+/// 参数：
+/// - handle: 数据库连接句柄 ID
+/// 
+/// 返回：
+/// - mysql_errno 的错误码（0 表示没有错误），句柄无效时返回 -1
+int autumn_mysql_errno(int handle) {
+    MYSQL* mysql = get_mysql(handle);
+    if (mysql == NULL) {
+        return -1;
+    }
+    return (int)mysql_errno(mysql);
+}
+
+/// MySQL 获取最后一条语句影响的行数（适配 MoonBit FFI）
+/// 
+/// 参数：
+/// - handle: 数据库连接句柄 ID
+/// 
+/// 返回：
+/// - 最后一条成功执行的语句影响的行数（预编译语句取 mysql_stmt_affected_rows，
+///   文本协议取 mysql_affected_rows），句柄无效或行数未知时返回 -1
+int autumn_mysql_affected_rows(int handle) {
+    if (get_mysql(handle) == NULL) {
+        return -1;
+    }
+    long long affected = mysql_last_affected[handle];
+    if (affected < 0) {
+        return -1;
+    }
+    return affected > INT_MAX ? INT_MAX : (int)affected;
+}
+